@@ -1,4 +1,7 @@
 #include "L2.h"
+#include "hex_codec.h"
+#include "nic_context.h"
+#include <stdexcept>
 
 using namespace common;
 
@@ -11,53 +14,34 @@ using namespace common;
 * @return New L2 packet object.
 */
 L2::L2(L3 &base, std::string packet_str): L3(base) {
-	int bar_cnt = 0;
-
-	std::string src_mac_str = extract_between_delimiters(packet_str,
-														'|',
-														bar_cnt,
-														bar_cnt);
-	bar_cnt++;
-
-	std::string dst_mac_str = extract_between_delimiters(packet_str,
-														'|',
-														bar_cnt,
-														bar_cnt);
-	bar_cnt++;
-
-	std::string cs_str = extract_between_delimiters(packet_str,
-													'|',
-													CS_L2_BAR_NUM);
-
-	uint8_t* src_mac_arr = new uint8_t[MAC_SIZE];
-	mac_to_arr(src_mac_str, src_mac_arr);
-	this->src_mac = src_mac_arr;
-
-	uint8_t* dst_mac_arr = new uint8_t[MAC_SIZE];
-	mac_to_arr(dst_mac_str, dst_mac_arr);
-	this->dst_mac = dst_mac_arr;
-
-	this->cs = std::stoi(cs_str);
+	packet_tokenizer tokenizer(packet_str);
+	this->parse_header(tokenizer.get_fields());
+	this->set_layer(LAYER_L2);
 }
 
 /**
 * @fn L2
-* @brief Copy Constructor of the class
-* @param base - L2 packet to copy.
-* @return New copy of L2 packet.
+* @brief Constructor of the class from an already tokenized packet.
+* @param fields[] - All MAX_PACKET_FIELDS fields of the packet:
+*		 src_mac, dst_mac, L3 packet's fields, cs.
+* @return New L2 packet object.
 */
-L2::L2(const L2 &base): L3(base) {
-	uint8_t* src_mac_arr = new uint8_t[MAC_SIZE];
-	uint8_t* dst_mac_arr = new uint8_t[MAC_SIZE];
-
-	for (int i = 0; i < MAC_SIZE; i++) {
-		src_mac_arr[i] = base.src_mac[i];
-		dst_mac_arr[i] = base.dst_mac[i];
-	}
+L2::L2(const str_view fields[]): L3(fields + L2_HEADER_FIELDS) {
+	this->parse_header(fields);
+	this->set_layer(LAYER_L2);
+}
 
-	this->src_mac = src_mac_arr;
-	this->dst_mac = dst_mac_arr;
-	this->cs = base.cs;
+/**
+* @fn L2
+* @brief Constructor of the class from a packet record.
+* @param record - The record to take the properties of all layers from.
+* @return New L2 packet object.
+*/
+L2::L2(const packet_record &record): L3(record) {
+	this->src_mac = record.src_mac;
+	this->dst_mac = record.dst_mac;
+	this->cs = record.L2_cs;
+	this->set_layer(LAYER_L2);
 }
 
 /**
@@ -74,8 +58,40 @@ bool L2::validate_packet(open_port_vec open_ports,
                      uint8_t mask,
                      uint8_t mac[MAC_SIZE]) {
 
-	return L3::comp_arr(mac, this->dst_mac, MAC_SIZE) &&
-			this->cs == this->calc_sum();
+	return this->L2::check_packet(open_ports, ip, mask, mac);
+}
+
+/**
+* @fn check_packet
+* @brief Same as validate_packet, without copying open_ports.
+* @param open_ports - A vector of all NIC's open ports.
+* @param ip - NIC's IP address, represented via an array.
+* @param mask - The mask of the NIC's that determine the local net.
+* @param mac - NIC's MAC address, represented via an array.
+* @return True upon success, false otherwise. 
+*/
+bool L2::check_packet(const open_port_vec &open_ports,
+                      uint8_t ip[IP_V4_SIZE],
+                      uint8_t mask,
+                      uint8_t mac[MAC_SIZE]) {
+
+	/* a bound packet is checked by all dst MACs its NIC accepts */
+	const nic_context* nic = this->get_nic();
+	uint64_t dst_key = mac_filter::to_key(this->dst_mac.data());
+	bool accepted = (nic != nullptr ? nic->macs.accepts(dst_key) :
+					 L3::comp_arr(mac, this->dst_mac.data(), MAC_SIZE));
+
+	if (!accepted) {
+		this->set_drop_reason(DROP_L2_MAC);
+		return false;
+	}
+
+	if (this->cs != this->calc_sum()) {
+		this->set_drop_reason(DROP_L2_CS);
+		return false;
+	}
+
+	return true;
 }
 
 /**
@@ -92,7 +108,7 @@ bool L2::proccess_packet(open_port_vec &open_ports,
                      uint8_t mask,
                      memory_dest &dst) {
 
-	if (this->L3::validate_packet(open_ports, ip, mask, nullptr)) { 
+	if (this->L3::check_packet(open_ports, ip, mask, nullptr)) { 
 		return this->L3::proccess_packet(open_ports, ip, mask, dst);
 	}
 
@@ -108,26 +124,81 @@ bool L2::proccess_packet(open_port_vec &open_ports,
 * @return True upon success, false otherwise.
 */
 bool L2::as_string(std::string &packet) {
-	std::string L3_str = "";
-	if(!this->L3::as_string(L3_str)) {
-		return false;
-	}
+	out_buffer &out = string_buffer();
+	this->L2::write(out);
+	packet.assign(out.data(), out.size());
 
-	packet = L3_str;
-	
 	return true;
 }
 
+/**
+* @fn write
+* @brief Same as as_string, appending to a buffer. L2 header isn't
+*		 written, the packet leaves the NIC as its L3 packet.
+* @param out[out] - The buffer to append the packet to.
+* @return None.
+*/
+void L2::write(out_buffer &out) const {
+	this->L3::write(out);
+}
+
 
 /**
-* @fn ~L2
-* @brief Destructs L2 object, 
-*        deletes all dynamically allocated memory.
+* @fn to_record
+* @brief Writes packet properties into a flat record.
+* @param record[out] - The record to fill, zeroed first.
 * @return None.
 */
-L2::~L2() {
-	delete[] this->src_mac;
-	delete[] this->dst_mac;
+void L2::to_record(packet_record &record) const {
+	this->L3::to_record(record);
+
+	record.layer = LAYER_L2;
+	record.src_mac = this->src_mac;
+	record.dst_mac = this->dst_mac;
+	record.L2_cs = this->cs;
+}
+
+/**
+* @fn parse_record
+* @brief Parses a tokenized packet straight into a flat record,
+*		 without creating a packet object.
+* @param fields[] - All MAX_PACKET_FIELDS fields of the packet:
+*		 src_mac, dst_mac, L3 packet's fields, cs.
+* @param record[out] - The record to fill, zeroed first.
+* @return None.
+*/
+void L2::parse_record(const str_view fields[], packet_record &record) {
+	L3::parse_record(fields + L2_HEADER_FIELDS, record);
+
+	record.layer = LAYER_L2;
+	mac_to_arr(fields[SRC_MAC_FIELD], record.src_mac.data());
+	mac_to_arr(fields[DST_MAC_FIELD], record.dst_mac.data());
+	record.L2_cs = field_to_uint(fields[CS_L2_BAR_NUM]);
+}
+
+/**
+* @fn write_record
+* @brief Writes an L2 packet record the way as_string writes the
+*		 packet, which is its L3 packet.
+* @param record - The packet record.
+* @param out[out] - The buffer to append the packet to.
+* @return None.
+*/
+void L2::write_record(const packet_record &record, out_buffer &out) {
+	L3::write_record(record, out);
+}
+
+/**
+* @fn parse_header
+* @brief Sets L2 properties from the fields of the packet.
+* @param fields[] - All MAX_PACKET_FIELDS fields of the packet.
+* @return None.
+*/
+void L2::parse_header(const str_view fields[]) {
+	mac_to_arr(fields[SRC_MAC_FIELD], this->src_mac.data());
+	mac_to_arr(fields[DST_MAC_FIELD], this->dst_mac.data());
+
+	this->cs = field_to_uint(fields[CS_L2_BAR_NUM]);
 }
 
 /**
@@ -185,31 +256,23 @@ std::string L2::mac_to_str(uint8_t mac[]) {
 * @brief convert MAC address written as string into an array.
 * @param mac - the mac as string to convert.
 * @param mac_arr[out] - The destination array to write the MAC into.
-* @return void
+* @return void, throws std::invalid_argument unless the MAC is six
+*		  pairs of hex digits separated by ':'.
 */
-void L2::mac_to_arr(std::string mac, uint8_t mac_arr[]) {
-	std::string chunk;
-    for (int i = 0; i < MAC_SIZE - 1; i++) {
-
-        chunk = extract_between_delimiters(mac, ':', i, i);
-
-        int num = 0;
-        for (int j = 0; j < HEX_DIG_IN_BYTE; j++) {
-            num *= HEX_BASE;
-            num += L4::hex_to_dec(chunk[j]);
-        }
-
-        mac_arr[i] = num;
-    }
-
-    chunk = extract_between_delimiters(mac, ':', MAC_SIZE - 1);
-
-    int num = 0;
-    for (int j = 0; j < HEX_DIG_IN_BYTE; j++) {
-        num *= HEX_BASE;
-        num += L4::hex_to_dec(chunk[j]);
-    }
+void L2::mac_to_arr(str_view mac, uint8_t mac_arr[]) {
+	if (mac.len != MAC_STR_LEN) {
+		throw std::invalid_argument("Malformed MAC address.");
+	}
 
-    mac_arr[MAC_SIZE - 1] = num;
+	for (size_t sep = 2; sep < MAC_STR_LEN; sep += 3) {
+		if (mac.ptr[sep] != ':') {
+			throw std::invalid_argument("Malformed MAC address.");
+		}
+	}
 
+	/* the pairs are laid out as in a hex dump, with ':' for spaces. The
+	   length is exact, so no digit is missing and each is checked. */
+	if (!hex_codec::decode(mac, mac_arr, MAC_SIZE)) {
+		throw std::invalid_argument("Malformed MAC address.");
+	}
 }
@@ -7,14 +7,27 @@
 #include "packets.hpp"
 #include "L3.h"
 
+/* Num of chars of a MAC address, "xx:xx:xx:xx:xx:xx" */
+const size_t MAC_STR_LEN = MAC_SIZE * HEX_CHARS_PER_BYTE - 1;
+
 /* Number of '|' until reaching CS segmant in L2 */
 const int CS_L2_BAR_NUM = 10;
 
+/* Order of the fields in L2 header, followed by L3 packet's fields */
+enum L2_fields {
+    SRC_MAC_FIELD,
+    DST_MAC_FIELD,
+    L2_HEADER_FIELDS
+};
+
 class L2: public L3 {
-	uint8_t* src_mac;
-	uint8_t* dst_mac;
+	std::array<uint8_t, MAC_SIZE> src_mac;
+	std::array<uint8_t, MAC_SIZE> dst_mac;
 	unsigned int cs;
 
+	/* benchmarks call the checksum helpers directly */
+	friend class nic_bench;
+
 	public:
 		/**
 		* @fn L2
@@ -28,11 +41,20 @@ class L2: public L3 {
 
 		/**
 		* @fn L2
-		* @brief Copy Constructor of the class
-		* @param base - L2 packet to copy.
-		* @return New copy of L2 packet.
+		* @brief Constructor of the class from an already tokenized packet.
+		* @param fields[] - All MAX_PACKET_FIELDS fields of the packet:
+		*		 src_mac, dst_mac, L3 packet's fields, cs.
+		* @return New L2 packet object.
 		*/
-		L2(const L2 &base);
+		L2(const str_view fields[]);
+
+		/**
+		* @fn L2
+		* @brief Constructor of the class from a packet record.
+		* @param record - The record to take the properties of all layers from.
+		* @return New L2 packet object.
+		*/
+		L2(const packet_record &record);
 
 		/**
 		* @fn validate_packet
@@ -48,6 +70,20 @@ class L2: public L3 {
                              uint8_t mask,
                              uint8_t mac[MAC_SIZE]);
 
+		/**
+		* @fn check_packet
+		* @brief Same as validate_packet, without copying open_ports.
+		* @param open_ports - A vector of all NIC's open ports.
+		* @param ip - NIC's IP address, represented via an array.
+		* @param mask - The mask of the NIC's that determine the local net.
+		* @param mac - NIC's MAC address, represented via an array.
+		* @return True upon success, false otherwise. 
+		*/
+		bool check_packet(const open_port_vec &open_ports,
+                          uint8_t ip[IP_V4_SIZE],
+                          uint8_t mask,
+                          uint8_t mac[MAC_SIZE]);
+
 		/**
 		* @fn packet_proccess
 		* @brief Proccess L2 packet as specified.
@@ -72,24 +108,64 @@ class L2: public L3 {
 		bool as_string(std::string &packet);
 
 		/**
-		* @fn ~L2
-		* @brief Destructs L2 object, 
-		*        deletes all dynamically allocated memory.
+		* @fn write
+		* @brief Same as as_string, appending to a buffer. L2 header isn't
+		*		 written, the packet leaves the NIC as its L3 packet.
+		* @param out[out] - The buffer to append the packet to.
+		* @return None.
+		*/
+		void write(out_buffer &out) const;
+
+		/**
+		* @fn to_record
+		* @brief Writes packet properties into a flat record.
+		* @param record[out] - The record to fill, zeroed first.
+		* @return None.
+		*/
+		void to_record(packet_record &record) const;
+
+		/**
+		* @fn parse_record
+		* @brief Parses a tokenized packet straight into a flat record,
+		*		 without creating a packet object.
+		* @param fields[] - All MAX_PACKET_FIELDS fields of the packet:
+		*		 src_mac, dst_mac, L3 packet's fields, cs.
+		* @param record[out] - The record to fill, zeroed first.
 		* @return None.
 		*/
-		~L2();
+		static void parse_record(const str_view fields[],
+								 packet_record &record);
+
+		/**
+		* @fn write_record
+		* @brief Writes an L2 packet record the way as_string writes the
+		*		 packet, which is its L3 packet.
+		* @param record - The packet record.
+		* @param out[out] - The buffer to append the packet to.
+		* @return None.
+		*/
+		static void write_record(const packet_record &record, out_buffer &out);
 
 		/**
 		* @fn mac_to_arr
 		* @brief convert MAC address written as string into an array.
 		* @param mac - the mac as string to convert.
 		* @param mac_arr[out] - The destination array to write the MAC into.
-		* @return void
+		* @return void, throws std::invalid_argument unless the MAC is six
+		*		  pairs of hex digits separated by ':'.
 		*/
-		static void mac_to_arr(std::string mac, uint8_t mac_arr[]);
+		static void mac_to_arr(str_view mac, uint8_t mac_arr[]);
 
 	protected:
 
+		/**
+		* @fn parse_header
+		* @brief Sets L2 properties from the fields of the packet.
+		* @param fields[] - All MAX_PACKET_FIELDS fields of the packet.
+		* @return None.
+		*/
+		void parse_header(const str_view fields[]);
+
 		/**
 		* @fn calc_sum
 		* @brief Sums all bytes of each property of the packet, other then cs.
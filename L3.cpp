@@ -1,7 +1,103 @@
 #include "L3.h"
+#include "nic_context.h"
+#include <stdexcept>
 
 using namespace common;
 
+/**
+* @fn ipv4_subnet
+* @brief Constructor of the class, 0.0.0.0/0 that contains all.
+* @return New subnet object.
+*/
+ipv4_subnet::ipv4_subnet(): net(0), mask(0) {}
+
+/**
+* @fn ipv4_subnet
+* @brief Constructor of the class.
+* @param ip[] - An IP address in the subnet, as an array.
+* @param prefix_len - Num of leading bits that define the subnet.
+* @return New subnet object.
+*/
+ipv4_subnet::ipv4_subnet(const uint8_t ip[], uint8_t prefix_len) {
+	this->mask = prefix_to_mask(prefix_len);
+	this->net = ip_to_uint(ip) & this->mask;
+}
+
+/**
+* @fn contains
+* @brief Checks whether an IP address belongs to the subnet.
+* @param ip - The IP address, see ip_to_uint.
+* @return True if it belongs, false otherwise.
+*/
+bool ipv4_subnet::contains(uint32_t ip) const {
+	return (ip & this->mask) == this->net;
+}
+
+/**
+* @fn contains
+* @brief Checks whether an IP address belongs to the subnet.
+* @param ip[] - The IP address as an array.
+* @return True if it belongs, false otherwise.
+*/
+bool ipv4_subnet::contains(const uint8_t ip[]) const {
+	return this->contains(ip_to_uint(ip));
+}
+
+/**
+* @fn classify
+* @brief Checks for many IP addresses whether they belong to the
+*		 subnet, in one branchless loop.
+* @param ips[] - The IP addresses, see ip_to_uint.
+* @param ips_num - Num of IP addresses.
+* @param in_net[out] - Whether each IP address belongs.
+* @return None.
+*/
+void ipv4_subnet::classify(const uint32_t ips[],
+						   int ips_num,
+						   bool in_net[]) const {
+	const uint32_t net = this->net;
+	const uint32_t mask = this->mask;
+
+	for (int i = 0; i < ips_num; i++) {
+		in_net[i] = ((ips[i] & mask) == net);
+	}
+}
+
+/**
+* @fn ip_to_uint
+* @brief Packs an IP address array into 32 bits, first entry in the
+*		 most significant byte.
+* @param ip[] - The IP address as an array.
+* @return The IP address as a number.
+*/
+uint32_t ipv4_subnet::ip_to_uint(const uint8_t ip[]) {
+	uint32_t num = 0;
+
+	for (int i = 0; i < IP_V4_SIZE; i++) {
+		num = (num << SIZE_OF_BYTE) | ip[i];
+	}
+
+	return num;
+}
+
+/**
+* @fn prefix_to_mask
+* @brief Builds the mask of a prefix length.
+* @param prefix_len - Num of leading bits set in the mask.
+* @return The mask.
+*/
+uint32_t ipv4_subnet::prefix_to_mask(uint8_t prefix_len) {
+	if (prefix_len == 0) {
+		return 0;
+	}
+
+	if (prefix_len >= IP_V4_BITS) {
+		return ~0u;
+	}
+
+	return ~0u << (IP_V4_BITS - prefix_len);
+}
+
 /**
 * @fn L3
 * @brief Constructor of the class
@@ -11,63 +107,35 @@ using namespace common;
 * @return New L3 packet object.
 */
 L3::L3(L4 &base, std::string packet_str): L4(base) {
-	int bar_cnt = 0;
-
-	std::string src_ip_str = extract_between_delimiters(packet_str,
-														'|',
-														bar_cnt,
-														bar_cnt);
-	bar_cnt++;
-
-	std::string dst_ip_str = extract_between_delimiters(packet_str,
-														'|',
-														bar_cnt,
-														bar_cnt);
-	bar_cnt++;
-
-	std::string ttl_str = extract_between_delimiters(packet_str,
-													'|',
-													bar_cnt,
-													bar_cnt);
-	bar_cnt++;
-
-	std::string cs_str = extract_between_delimiters(packet_str,
-													'|',
-													bar_cnt);
-
-	uint8_t* src_ip_arr = new uint8_t[IP_V4_SIZE];
-	ip_to_arr(src_ip_str, src_ip_arr);
-	this->src_ip = src_ip_arr;
-
-	uint8_t* dst_ip_arr = new uint8_t[IP_V4_SIZE];
-	ip_to_arr(dst_ip_str, dst_ip_arr);
-	this->dst_ip = dst_ip_arr;
-
-	this->ttl = std::stoi(ttl_str);
-	this->cs = std::stoi(cs_str);
+	packet_tokenizer tokenizer(packet_str);
+	this->parse_header(tokenizer.get_fields());
+	this->set_layer(LAYER_L3);
 }
 
 /**
 * @fn L3
-* @brief Copy Constructor of the class
-* @param base - L3 packet to copy.
-* @return New copy of L3 packet.
+* @brief Constructor of the class from an already tokenized packet.
+* @param fields[] - L3_HEADER_FIELDS fields of the header, in order:
+*		 src_ip, dst_ip, ttl, cs. Followed by L4 packet's fields.
+* @return New L3 packet object.
 */
-L3::L3(const L3 &base): L4(base) {
-	uint8_t* src_ip_arr = new uint8_t[IP_V4_SIZE];
-	uint8_t* dst_ip_arr = new uint8_t[IP_V4_SIZE];
-
-	for (int i = 0; i < IP_V4_SIZE; i++) {
-		src_ip_arr[i] = base.src_ip[i];
-		dst_ip_arr[i] = base.dst_ip[i];
-	}
-
-	this->src_ip = src_ip_arr;
-	this->dst_ip = dst_ip_arr;
+L3::L3(const str_view fields[]): L4(fields + L3_HEADER_FIELDS) {
+	this->parse_header(fields);
+	this->set_layer(LAYER_L3);
+}
 
-	
-	this->ttl = base.ttl;
-	this->cs = base.cs;
+/**
+* @fn L3
+* @brief Constructor of the class from a packet record.
+* @param record - The record to take L3 and L4 properties from.
+* @return New L3 packet object.
+*/
+L3::L3(const packet_record &record): L4(record) {
+	this->src_ip = record.src_ip;
+	this->dst_ip = record.dst_ip;
+	this->ttl = record.ttl;
+	this->cs = record.L3_cs;
+	this->set_layer(LAYER_L3);
 }
 
 /**
@@ -84,8 +152,34 @@ bool L3::validate_packet(open_port_vec open_ports,
                      uint8_t mask,
                      uint8_t mac[MAC_SIZE]) {
 
-	return this->ttl > 0 && this->cs == L3::calc_sum();
-	
+	return this->L3::check_packet(open_ports, ip, mask, mac);
+}
+
+/**
+* @fn check_packet
+* @brief Same as validate_packet, without copying open_ports.
+* @param open_ports - A vector of all NIC's open ports.
+* @param ip[] - NIC's IP address, represented via an array.
+* @param mask - The mask of the NIC's that determine the local net.
+* @param mac[] - NIC's MAC address, represented via an array.
+* @return True upon success, false otherwise. 
+*/
+bool L3::check_packet(const open_port_vec &open_ports,
+                      uint8_t ip[IP_V4_SIZE],
+                      uint8_t mask,
+                      uint8_t mac[MAC_SIZE]) {
+
+	if (this->ttl == 0) {
+		this->set_drop_reason(DROP_TTL_EXPIRED);
+		return false;
+	}
+
+	if (this->cs != L3::calc_sum()) {
+		this->set_drop_reason(DROP_L3_CS);
+		return false;
+	}
+
+	return true;
 }
 
 /**
@@ -103,13 +197,13 @@ bool L3::proccess_packet(open_port_vec &open_ports,
                      memory_dest &dst) {
 
 	/* dst ip same as NIC's => L4 (2.4) */
-	if (comp_arr(ip, this->dst_ip, IP_V4_SIZE)) {
+	if (comp_arr(ip, this->dst_ip.data(), IP_V4_SIZE)) {
 		
 		dst = LOCAL_DRAM;	
 		
 		bool L4_flag = true;
 
-		if (this->L4::validate_packet(open_ports, ip, mask, nullptr)) {
+		if (this->L4::check_packet(open_ports, ip, mask, nullptr)) {
 
 			L4_flag = this->L4::proccess_packet(open_ports,
 												ip,
@@ -123,34 +217,60 @@ bool L3::proccess_packet(open_port_vec &open_ports,
 		return this->ttl > 0 && L4_flag;
 	}
 
+	/* cs was checked by check_packet, only the changed fields are summed */
+	unsigned int old_ttl_sum = L4::sum_bytes(this->ttl);
 	this->ttl--;
-	this->cs = calc_sum();
+	this->update_cs(old_ttl_sum, L4::sum_bytes(this->ttl));
 
 	/* Packet invalid */
 	if (ttl == 0) {
+		this->set_drop_reason(DROP_TTL_EXPIRED);
 		return false;
 	}
 
+	/* bound NIC has its local net precomputed */
+	const nic_context* nic = this->get_nic();
+	ipv4_subnet local_net = (nic != nullptr ? nic->local_net :
+											  ipv4_subnet(ip, mask));
+
+	bool src_local = local_net.contains(this->src_ip.data());
+	bool dst_local = local_net.contains(this->dst_ip.data());
+
 	/* both belongs to local net => ignore (2.5) */
-	if (in_local_net(ip, this->src_ip, mask) &&
-		in_local_net(ip, this->dst_ip, mask)) {
+	if (src_local && dst_local) {
+		this->set_drop_reason(DROP_LOCAL_TO_LOCAL);
+		return false;
+	}
+
+	/* NIC's routes decide by dst, packets none match go by local net */
+	route_action route = (nic != nullptr ?
+						  nic->routes.lookup(ipv4_subnet::ip_to_uint(
+							  this->dst_ip.data())) :
+						  ROUTE_NONE);
+
+	if (route == ROUTE_DROP) {
+		this->set_drop_reason(DROP_ROUTE);
 		return false;
 	}
 
 	/* dst belongs, src doesnt => in (2.1)*/
-	if (in_local_net(ip, this->dst_ip, mask)) {
+	if (route == ROUTE_RQ || (route == ROUTE_NONE && dst_local)) {
 		dst = RQ;
 
 		return true;
 	}
 
 	/* src belongs, dst doesnt => out (2.2)*/
-	if (in_local_net(ip, this->src_ip, mask)) {
+	if (src_local) {
+		unsigned int old_ip_sum = 0;
+		unsigned int new_ip_sum = 0;
 		for (int i = 0; i < IP_V4_SIZE; i++) {
+			old_ip_sum += this->src_ip[i];
+			new_ip_sum += ip[i];
 			this->src_ip[i] = ip[i];
 		}
 		
-		this->cs = calc_sum();
+		this->update_cs(old_ip_sum, new_ip_sum);
 		dst = TQ;
 		return true;
 	}
@@ -169,31 +289,100 @@ bool L3::proccess_packet(open_port_vec &open_ports,
 * @return True upon success, false otherwise.
 */
 bool L3::as_string(std::string &packet) {
-	std::string L4_str = "";
-	if (!this->L4::as_string(L4_str)) {
-		return false;
-	}
-
-	packet = ip_to_str(this->src_ip) + "|" +
-			 ip_to_str(this->dst_ip) + "|" +
-			 std::to_string(this->ttl) + "|" +
-			 std::to_string(this->cs) + "|" +
-			 L4_str;
+	out_buffer &out = string_buffer();
+	this->L3::write(out);
+	packet.assign(out.data(), out.size());
 
 	return true;
 }
 
 /**
-* @fn ~L3
-* @brief Destructs L3 object, 
-*        deletes all dynamically allocated memory.
+* @fn write
+* @brief Same as as_string, appending to a buffer.
+* @param out[out] - The buffer to append the packet to.
 * @return None.
 */
-L3::~L3() {
-	delete[] this->src_ip;
-	delete[] this->dst_ip;
+void L3::write(out_buffer &out) const {
+	write_ip(this->src_ip.data(), out);
+	out.append('|');
+	write_ip(this->dst_ip.data(), out);
+	out.append('|');
+	out.append_uint(this->ttl);
+	out.append('|');
+	out.append_uint(this->cs);
+	out.append('|');
+	this->L4::write(out);
 }
 
+/**
+* @fn to_record
+* @brief Writes packet properties into a flat record.
+* @param record[out] - The record to fill, zeroed first.
+* @return None.
+*/
+void L3::to_record(packet_record &record) const {
+	this->L4::to_record(record);
+
+	record.layer = LAYER_L3;
+	record.src_ip = this->src_ip;
+	record.dst_ip = this->dst_ip;
+	record.ttl = this->ttl;
+	record.L3_cs = this->cs;
+}
+
+/**
+* @fn parse_record
+* @brief Parses a tokenized packet straight into a flat record,
+*		 without creating a packet object.
+* @param fields[] - L3_HEADER_FIELDS fields of the header, in order:
+*		 src_ip, dst_ip, ttl, cs. Followed by L4 packet's fields.
+* @param record[out] - The record to fill, zeroed first.
+* @return None.
+*/
+void L3::parse_record(const str_view fields[], packet_record &record) {
+	L4::parse_record(fields + L3_HEADER_FIELDS, record);
+
+	record.layer = LAYER_L3;
+	ip_to_arr(fields[SRC_IP_FIELD], record.src_ip.data());
+	ip_to_arr(fields[DST_IP_FIELD], record.dst_ip.data());
+	record.ttl = field_to_uint(fields[TTL_FIELD]);
+	record.L3_cs = field_to_uint(fields[L3_CS_FIELD]);
+}
+
+/**
+* @fn write_record
+* @brief Writes an L3 packet record the way as_string writes the
+*		 packet: "src_ip|dst_ip|ttl|cs|L4_packet".
+* @param record - The packet record.
+* @param out[out] - The buffer to append the packet to.
+* @return None.
+*/
+void L3::write_record(const packet_record &record, out_buffer &out) {
+	write_ip(record.src_ip.data(), out);
+	out.append('|');
+	write_ip(record.dst_ip.data(), out);
+	out.append('|');
+	out.append_uint(record.ttl);
+	out.append('|');
+	out.append_uint(record.L3_cs);
+	out.append('|');
+	L4::write_record(record, out);
+}
+
+
+/**
+* @fn parse_header
+* @brief Sets L3 properties from the fields of L3 header.
+* @param fields[] - L3_HEADER_FIELDS fields of the header.
+* @return None.
+*/
+void L3::parse_header(const str_view fields[]) {
+	ip_to_arr(fields[SRC_IP_FIELD], this->src_ip.data());
+	ip_to_arr(fields[DST_IP_FIELD], this->dst_ip.data());
+
+	this->ttl = field_to_uint(fields[TTL_FIELD]);
+	this->cs = field_to_uint(fields[L3_CS_FIELD]);
+}
 
 /**
 * @fn calc_sum
@@ -213,6 +402,19 @@ unsigned int L3::calc_sum() const {
 	return L4_sum + ips_sum + ttl_sum;
 }
 
+/**
+* @fn update_cs
+* @brief Updates cs after a field changed, by the change of the
+*		 field's bytes sum, instead of summing the packet again.
+*		 cs must be valid before the change (see check_packet).
+* @param old_sum - Sum of the field's bytes before the change.
+* @param new_sum - Sum of the field's bytes after the change.
+* @return None.
+*/
+void L3::update_cs(unsigned int old_sum, unsigned int new_sum) {
+	this->cs = this->cs - old_sum + new_sum;
+}
+
 /**
 * @fn in_local_net
 * @brief checks whether two ip adresses are in the same local net.
@@ -224,47 +426,24 @@ unsigned int L3::calc_sum() const {
 */
 bool L3::in_local_net(uint8_t ip1[], uint8_t ip2[], uint8_t mask) {
 
-	return get_masked_ip(ip1, mask) == get_masked_ip(ip2, mask);
-}
-
-/**
-* @fn get_masked_ip
-* @brief returns a string with 32 chars, the first 'mask' bits are
-*		 the IP address in binary, the rest are 0.
-* @param ip[] - The IP that should be masked.
-* @param mask - The number of bits the should be regarded.
-* @return A string with 32 chars that describes the masked IP.
-*/
-std::string L3::get_masked_ip(uint8_t ip[], uint8_t mask) {
-	std::string ip_str = "";
-
-	for (int i = 0; i < IP_V4_SIZE; i++) {
-		std::string bin_entry = dec_to_binary(ip[i]);
-		ip_str += bin_entry;
-	}
-
-	std::string ip_masked = ip_str.substr(0, mask);
-
-	return ip_masked;
-
+	return ipv4_subnet(ip1, mask).contains(ip2);
 }
 
 /**
-* @fn ip_to_str
-* @brief converts an IP described by an array to string in format:
+* @fn write_ip
+* @brief Appends an IP described by an array to a buffer in format:
 *		 "***.***.***.***"
-* @param ip[] - The IP as an array, that should be written as string.
-* @return The IP address as a string.
+* @param ip[] - The IP as an array that should be written.
+* @param out[out] - The buffer to append the IP to.
+* @return None.
 */
-std::string L3::ip_to_str(uint8_t ip[]) {
-	std::string str = "";
+void L3::write_ip(const uint8_t ip[], out_buffer &out) {
 	for (int i = 0; i < IP_V4_SIZE - 1; i++) {
-		str += std::to_string(ip[i]) + ".";
+		out.append_uint(ip[i]);
+		out.append('.');
 	}
 
-	str += std::to_string(ip[IP_V4_SIZE - 1]);
-
-	return str;
+	out.append_uint(ip[IP_V4_SIZE - 1]);
 }
 
 /**
@@ -272,37 +451,38 @@ std::string L3::ip_to_str(uint8_t ip[]) {
 * @brief convert IP address written as string into an array.
 * @param ip - the IP as string to convert.
 * @param ip_arr[] [out] - The destination array to write the IP into.
-* @return void
+* @return void, throws std::invalid_argument unless the IP is four '.'
+*		  separated numbers of 1 to 3 digits, up to 255.
 */
-void L3::ip_to_arr(std::string ip, uint8_t ip_arr[]){ 
-	std::string chunk;
-    for (int i = 0; i < IP_V4_SIZE - 1; i++) {
-        chunk = extract_between_delimiters(ip, '.', i, i);
-
-        ip_arr[i] = std::stoi(chunk);
-    }
-
-    chunk = extract_between_delimiters(ip, '.', IP_V4_SIZE - 1);
-    ip_arr[IP_V4_SIZE - 1] = std::stoi(chunk);
-}  
-
-/**
-* @fn dec_to_binary
-* @brief converts number in decimal into its binary respresenation.
-* @param num - A num in decimal base.
-* @return A string that contains the number in binary.
-*/
-std::string L3::dec_to_binary(uint8_t num) {
-	std::string bin_num = "00000000";
+void L3::ip_to_arr(str_view ip, uint8_t ip_arr[]) {
+	const int max_octet_digits = 3;
+	size_t i = 0;
+
+	for (int entry = 0; entry < IP_V4_SIZE; entry++) {
+		if (entry > 0) {
+			if (i == ip.len || ip.ptr[i] != '.') {
+				throw std::invalid_argument("Malformed IP address.");
+			}
+			i++;
+		}
 
-	for (int i = SIZE_OF_BYTE - 1; i >= 0; i--) {
+		unsigned int octet = 0;
+		int digits = 0;
+		for (; i < ip.len && ip.ptr[i] >= '0' && ip.ptr[i] <= '9'; i++) {
+			octet = octet * DEC_BASE + (ip.ptr[i] - '0');
+			digits++;
+		}
 
-		bin_num[i] = ((num % 2 == 1) ? '1' : '0');
+		if (digits == 0 || digits > max_octet_digits || octet > UINT8_MAX) {
+			throw std::invalid_argument("Malformed IP address.");
+		}
 
-		num /= 2;
+		ip_arr[entry] = octet;
 	}
 
-	return bin_num;
+	if (i != ip.len) {
+		throw std::invalid_argument("Malformed IP address.");
+	}
 }
 
 /**
@@ -9,14 +9,97 @@
 
 /* Max num of dec digit in one ip entry */
 const int MAX_IP_SIZE = 3;
+/* Num of bits in IPv4 address */
+const int IP_V4_BITS = 32;
 
+/* Order of the fields in L3 header, followed by L4 packet's fields */
+enum L3_fields {
+    SRC_IP_FIELD,
+    DST_IP_FIELD,
+    TTL_FIELD,
+    L3_CS_FIELD,
+    L3_HEADER_FIELDS
+};
+
+
+/* An IPv4 subnet, kept as 32 bit network address and mask so checking if
+   an address belongs to it takes a single AND and compare */
+class ipv4_subnet {
+	uint32_t net;
+	uint32_t mask;
+
+	public:
+
+		/**
+		* @fn ipv4_subnet
+		* @brief Constructor of the class, 0.0.0.0/0 that contains all.
+		* @return New subnet object.
+		*/
+		ipv4_subnet();
+
+		/**
+		* @fn ipv4_subnet
+		* @brief Constructor of the class.
+		* @param ip[] - An IP address in the subnet, as an array.
+		* @param prefix_len - Num of leading bits that define the subnet.
+		* @return New subnet object.
+		*/
+		ipv4_subnet(const uint8_t ip[], uint8_t prefix_len);
+
+		/**
+		* @fn contains
+		* @brief Checks whether an IP address belongs to the subnet.
+		* @param ip - The IP address, see ip_to_uint.
+		* @return True if it belongs, false otherwise.
+		*/
+		bool contains(uint32_t ip) const;
+
+		/**
+		* @fn contains
+		* @brief Checks whether an IP address belongs to the subnet.
+		* @param ip[] - The IP address as an array.
+		* @return True if it belongs, false otherwise.
+		*/
+		bool contains(const uint8_t ip[]) const;
+
+		/**
+		* @fn classify
+		* @brief Checks for many IP addresses whether they belong to the
+		*		 subnet, in one branchless loop.
+		* @param ips[] - The IP addresses, see ip_to_uint.
+		* @param ips_num - Num of IP addresses.
+		* @param in_net[out] - Whether each IP address belongs.
+		* @return None.
+		*/
+		void classify(const uint32_t ips[], int ips_num, bool in_net[]) const;
+
+		/**
+		* @fn ip_to_uint
+		* @brief Packs an IP address array into 32 bits, first entry in the
+		*		 most significant byte.
+		* @param ip[] - The IP address as an array.
+		* @return The IP address as a number.
+		*/
+		static uint32_t ip_to_uint(const uint8_t ip[]);
+
+		/**
+		* @fn prefix_to_mask
+		* @brief Builds the mask of a prefix length.
+		* @param prefix_len - Num of leading bits set in the mask.
+		* @return The mask.
+		*/
+		static uint32_t prefix_to_mask(uint8_t prefix_len);
+};
 
 class L3: public L4 {
-	uint8_t* src_ip;
-	uint8_t* dst_ip;
+	std::array<uint8_t, IP_V4_SIZE> src_ip;
+	std::array<uint8_t, IP_V4_SIZE> dst_ip;
 	unsigned int ttl;
 	unsigned int cs;
 
+	/* benchmarks call the checksum and subnet helpers directly */
+	friend class nic_bench;
+
 	public:
 
 		/**
@@ -31,11 +114,20 @@ class L3: public L4 {
 
 		/**
 		* @fn L3
-		* @brief Copy Constructor of the class
-		* @param base - L3 packet to copy.
-		* @return New copy of L3 packet.
+		* @brief Constructor of the class from an already tokenized packet.
+		* @param fields[] - L3_HEADER_FIELDS fields of the header, in order:
+		*		 src_ip, dst_ip, ttl, cs. Followed by L4 packet's fields.
+		* @return New L3 packet object.
+		*/
+		L3(const str_view fields[]);
+
+		/**
+		* @fn L3
+		* @brief Constructor of the class from a packet record.
+		* @param record - The record to take L3 and L4 properties from.
+		* @return New L3 packet object.
 		*/
-		L3(const L3 &base);
+		L3(const packet_record &record);
 
 		/**
 		* @fn validate_packet
@@ -51,6 +143,20 @@ class L3: public L4 {
                              uint8_t mask,
                              uint8_t mac[MAC_SIZE]);
 
+		/**
+		* @fn check_packet
+		* @brief Same as validate_packet, without copying open_ports.
+		* @param open_ports - A vector of all NIC's open ports.
+		* @param ip[] - NIC's IP address, represented via an array.
+		* @param mask - The mask of the NIC's that determine the local net.
+		* @param mac - NIC's MAC address, represented via an array.
+		* @return True upon success, false otherwise. 
+		*/
+		bool check_packet(const open_port_vec &open_ports,
+                          uint8_t ip[IP_V4_SIZE],
+                          uint8_t mask,
+                          uint8_t mac[MAC_SIZE]);
+
 		/**
 		* @fn packet_proccess
 		* @brief Proccess L3 packet as specified.
@@ -75,12 +181,42 @@ class L3: public L4 {
 		bool as_string(std::string &packet);
 
 		/**
-		* @fn ~L3
-		* @brief Destructs L3 object, 
-		*        deletes all dynamically allocated memory.
+		* @fn write
+		* @brief Same as as_string, appending to a buffer.
+		* @param out[out] - The buffer to append the packet to.
+		* @return None.
+		*/
+		void write(out_buffer &out) const;
+
+		/**
+		* @fn to_record
+		* @brief Writes packet properties into a flat record.
+		* @param record[out] - The record to fill, zeroed first.
 		* @return None.
 		*/
-		~L3();
+		void to_record(packet_record &record) const;
+
+		/**
+		* @fn parse_record
+		* @brief Parses a tokenized packet straight into a flat record,
+		*		 without creating a packet object.
+		* @param fields[] - L3_HEADER_FIELDS fields of the header, in order:
+		*		 src_ip, dst_ip, ttl, cs. Followed by L4 packet's fields.
+		* @param record[out] - The record to fill, zeroed first.
+		* @return None.
+		*/
+		static void parse_record(const str_view fields[],
+								 packet_record &record);
+
+		/**
+		* @fn write_record
+		* @brief Writes an L3 packet record the way as_string writes the
+		*		 packet: "src_ip|dst_ip|ttl|cs|L4_packet".
+		* @param record - The packet record.
+		* @param out[out] - The buffer to append the packet to.
+		* @return None.
+		*/
+		static void write_record(const packet_record &record, out_buffer &out);
 
 
 		/**
@@ -88,12 +224,21 @@ class L3: public L4 {
 		* @brief convert IP address written as string into an array.
 		* @param ip - the ip as string to convert.
 		* @param ip_arr[] [out] - The destination array to write the ip into.
-		* @return void
+		* @return void, throws std::invalid_argument unless the IP is four
+		*		  '.' separated numbers of 1 to 3 digits, up to 255.
 		*/
-		static void ip_to_arr(std::string ip, uint8_t ip_arr[]);
+		static void ip_to_arr(str_view ip, uint8_t ip_arr[]);
 
 
 	protected:
+		/**
+		* @fn parse_header
+		* @brief Sets L3 properties from the fields of L3 header.
+		* @param fields[] - L3_HEADER_FIELDS fields of the header.
+		* @return None.
+		*/
+		void parse_header(const str_view fields[]);
+
 		/**
 		* @fn calc_sum
 		* @brief Sums all bytes of each property of the packet, other then cs.
@@ -101,6 +246,17 @@ class L3: public L4 {
 		*/
 		unsigned int calc_sum() const;
 
+		/**
+		* @fn update_cs
+		* @brief Updates cs after a field changed, by the change of the
+		*		 field's bytes sum, instead of summing the packet again.
+		*		 cs must be valid before the change (see check_packet).
+		* @param old_sum - Sum of the field's bytes before the change.
+		* @param new_sum - Sum of the field's bytes after the change.
+		* @return None.
+		*/
+		void update_cs(unsigned int old_sum, unsigned int new_sum);
+
 		/**
 		* @fn get_cs
 		* @brief A getter to the L3 cs property of the packet.
@@ -120,31 +276,14 @@ class L3: public L4 {
 		static bool in_local_net(uint8_t ip1[], uint8_t ip2[], uint8_t mask);
 
 		/**
-		* @fn get_masked_ip
-		* @brief returns a string with 32 chars, the first 'mask' bits are
-		*		 the IP address in binary, the rest are 0.
-		* @param ip - The IP that should be masked.
-		* @param mask - The number of bits the should be regarded.
-		* @return A string with 32 chars that describes the masked IP.
-		*/
-		static std::string get_masked_ip(uint8_t ip[], uint8_t mask);
-
-		/**
-		* @fn ip_to_str
-		* @brief converts an IP described by an array to string in format:
+		* @fn write_ip
+		* @brief Appends an IP described by an array to a buffer in format:
 		*		 "***.***.***.***"
-		* @param ip[] - The IP as an array that should be written as string.
-		* @return The IP address as a string.
-		*/
-		static std::string ip_to_str(uint8_t ip[]);
-
-		/**
-		* @fn dec_to_binary
-		* @brief converts number in decimal into its binary respresenation.
-		* @param num - A num in decimal base.
-		* @return A string that contains the number in binary.
+		* @param ip[] - The IP as an array that should be written.
+		* @param out[out] - The buffer to append the IP to.
+		* @return None.
 		*/
-		static std::string dec_to_binary(uint8_t num);
+		static void write_ip(const uint8_t ip[], out_buffer &out);
 
 		/**
 		* @fn comp_arr
@@ -1,5 +1,7 @@
 #include "L4.h"
+#include "nic_context.h"
 #include <algorithm>
+#include <stdexcept>
 #include <string>
 
 using namespace common;
@@ -11,56 +13,46 @@ using namespace common;
 *		 with the form: "src_port|dst_port|addrs|L5_data"
 * @return New L4 packet object.
 */
-L4::L4(const std::string packet_str) {
-	int bar_cnt = 0;
+L4::L4(const std::string packet_str):
+	L4(packet_tokenizer(packet_str).get_fields()) {}
 
-	std::string src_prt_str = extract_between_delimiters(packet_str,
-														'|',
-														bar_cnt,
-														bar_cnt);
-
-	bar_cnt++;
-
-	std::string dst_prt_str = extract_between_delimiters(packet_str,
-														'|',
-														bar_cnt,
-														bar_cnt);
-	bar_cnt++;
-
-	std::string addr_str = extract_between_delimiters(packet_str,
-													 '|',
-													 bar_cnt,
-													 bar_cnt);
-	bar_cnt++;
-
-	std::string data_str = extract_between_delimiters(packet_str,
-												 '|',
-												 bar_cnt);
-
-
-
-	this->src_port = std::stoi(src_prt_str);
-	this->dst_port = std::stoi(dst_prt_str);
-	this->addr = std::stoi(addr_str);
-	this->data = new unsigned char[DATA_L5_SIZE];
-	data_to_arr(data_str, this->data);
+/**
+* @fn L4
+* @brief Constructor of the class from an already tokenized packet.
+* @param fields[] - L4_FIELDS_NUM fields of the packet, in order:
+*		 src_port, dst_port, addrs, L5_data.
+* @return New L4 packet object.
+*/
+L4::L4(const str_view fields[]) {
+	this->src_port = field_to_uint(fields[SRC_PORT_FIELD], USHRT_MAX);
+	this->dst_port = field_to_uint(fields[DST_PORT_FIELD], USHRT_MAX);
+	this->addr = field_to_uint(fields[ADDR_FIELD]);
+	data_to_arr(fields[DATA_FIELD], this->data.data());
+
+	this->nic = nullptr;
+	this->port_slot = NO_PORT_SLOT;
+	this->sum = this->sum_fields();
+	this->layer = LAYER_L4;
+	this->drop = DROP_NONE;
 }
 
 /**
 * @fn L4
-* @brief Copy Constructor of the class
-* @param base - L4 packet to copy.
-* @return New copy of L4 packet.
+* @brief Constructor of the class from a packet record.
+* @param record - The record to take L4 properties from.
+* @return New L4 packet object.
 */
-L4::L4(const L4 &base) {
-	this->src_port = base.src_port;
-	this->dst_port = base.dst_port;
-	this->addr = base.addr;
-
-	this->data = new unsigned char[DATA_L5_SIZE];
-	for(int i = 0; i < DATA_L5_SIZE; i++) {
-		this->data[i] = base.data[i];
-	}
+L4::L4(const packet_record &record) {
+	this->src_port = record.src_port;
+	this->dst_port = record.dst_port;
+	this->addr = record.addr;
+	this->data = record.data;
+
+	this->nic = nullptr;
+	this->port_slot = NO_PORT_SLOT;
+	this->sum = this->sum_fields();
+	this->layer = LAYER_L4;
+	this->drop = DROP_NONE;
 }
 
 /**
@@ -78,13 +70,36 @@ bool L4::validate_packet(open_port_vec open_ports,
                         uint8_t mask,
                         uint8_t mac[MAC_SIZE]) {
 
-	auto port_iter = std::find_if(open_ports.begin(), open_ports.end(), 
-								 	[this](const open_port& port) {
-								return this->comp_ports(port);
-							});
+	return this->L4::check_packet(open_ports, ip, mask, mac);
+}
 
-	return (port_iter != open_ports.end() &&
-			this->addr <= DATA_ARR_SIZE - DATA_L5_SIZE);
+/**
+* @fn check_packet
+* @brief Same as validate_packet, without copying open_ports.
+* @param open_ports - A vector of all NIC's open ports.
+* @param ip[] - NIC's IP address, represented via an array.
+* @param mask - The mask of the NIC's that determine the local net.
+* @param mac - NIC's MAC address, represented via an array.
+* @return True upon success, false otherwise. 
+*/
+bool L4::check_packet(const open_port_vec &open_ports,
+                      uint8_t ip[IP_V4_SIZE],
+                      uint8_t mask,
+                      uint8_t mac[MAC_SIZE]) {
+
+	this->port_slot = this->find_port(open_ports);
+
+	if (this->port_slot == NO_PORT_SLOT) {
+		this->set_drop_reason(DROP_UNKNOWN_PORT);
+		return false;
+	}
+
+	if (this->addr > DATA_ARR_SIZE - DATA_L5_SIZE) {
+		this->set_drop_reason(DROP_ADDR_RANGE);
+		return false;
+	}
+
+	return true;
 }
 
 /**
@@ -101,13 +116,12 @@ bool L4::proccess_packet(open_port_vec &open_ports,
                      uint8_t mask,
                      memory_dest &dst) {
 
-	// check if the src_port and dst_port are in NIC.
-	auto port_iter = std::find_if(open_ports.begin(), open_ports.end(), 
-							[this](const open_port& port) {
-								return this->comp_ports(port);
-							});
+	// slot is carried from validate_packet, look it up only if missing.
+	if (this->port_slot == NO_PORT_SLOT) {
+		this->port_slot = this->find_port(open_ports);
+	}
 
-	open_port& port = *port_iter;
+	open_port& port = open_ports[this->port_slot];
 	
 	// write data in open_port starting from addr.
 	for (int i = 0; i < DATA_L5_SIZE; i++) {
@@ -126,24 +140,80 @@ bool L4::proccess_packet(open_port_vec &open_ports,
 * @return True upon success, false otherwise.
 */
 bool L4::as_string(std::string &packet) {
-	std::string data_str = arr_dec_to_hex(this->data, DATA_L5_SIZE);
-
-	packet = std::to_string(this->src_port) + "|" + 
-			 std::to_string(this->dst_port) + "|" + 
-			 std::to_string(this->addr) + "|" + 
-			 data_str;
+	out_buffer &out = string_buffer();
+	this->L4::write(out);
+	packet.assign(out.data(), out.size());
 
 	return true;
 }
 
 /**
-* @fn ~L4
-* @brief Destructs L4 object, 
-* deletes all dynamically allocated memory.
+* @fn write
+* @brief Same as as_string, appending to a buffer.
+* @param out[out] - The buffer to append the packet to.
+* @return None.
+*/
+void L4::write(out_buffer &out) const {
+	out.append_uint(this->src_port);
+	out.append('|');
+	out.append_uint(this->dst_port);
+	out.append('|');
+	out.append_uint(this->addr);
+	out.append('|');
+	out.append_hex(this->data.data(), DATA_L5_SIZE);
+}
+
+/**
+* @fn to_record
+* @brief Writes packet properties into a flat record.
+* @param record[out] - The record to fill, zeroed first.
+* @return None.
+*/
+void L4::to_record(packet_record &record) const {
+	record = packet_record();
+
+	record.layer = LAYER_L4;
+	record.src_port = this->src_port;
+	record.dst_port = this->dst_port;
+	record.addr = this->addr;
+	record.data = this->data;
+}
+
+/**
+* @fn parse_record
+* @brief Parses a tokenized packet straight into a flat record,
+*		 without creating a packet object.
+* @param fields[] - L4_FIELDS_NUM fields of the packet, in order:
+*		 src_port, dst_port, addrs, L5_data.
+* @param record[out] - The record to fill, zeroed first.
 * @return None.
 */
-L4::~L4() {
-	delete[] this->data;
+void L4::parse_record(const str_view fields[], packet_record &record) {
+	record = packet_record();
+
+	record.layer = LAYER_L4;
+	record.src_port = field_to_uint(fields[SRC_PORT_FIELD], USHRT_MAX);
+	record.dst_port = field_to_uint(fields[DST_PORT_FIELD], USHRT_MAX);
+	record.addr = field_to_uint(fields[ADDR_FIELD]);
+	data_to_arr(fields[DATA_FIELD], record.data.data());
+}
+
+/**
+* @fn write_record
+* @brief Writes an L4 packet record the way as_string writes the
+*		 packet: "src_port|dst_port|addrs|L5_data".
+* @param record - The packet record.
+* @param out[out] - The buffer to append the packet to.
+* @return None.
+*/
+void L4::write_record(const packet_record &record, out_buffer &out) {
+	out.append_uint(record.src_port);
+	out.append('|');
+	out.append_uint(record.dst_port);
+	out.append('|');
+	out.append_uint(record.addr);
+	out.append('|');
+	out.append_hex(record.data.data(), DATA_L5_SIZE);
 }
 
 /**
@@ -157,12 +227,149 @@ bool L4::comp_ports(const open_port& port) const {
 			port.dst_prt == this->dst_port);
 }
 
+/**
+* @fn find_port
+* @brief Finds the slot of the open port matching the packet's ports.
+*		 Uses the bound NIC's index if there is one, scans otherwise.
+* @param open_ports - A vector of all NIC's open ports.
+* @return The slot in open_ports, NO_PORT_SLOT if there is no match.
+*/
+int L4::find_port(const open_port_vec& open_ports) const {
+	if (this->nic != nullptr) {
+		const open_port_idx &port_idx = this->nic->port_idx;
+		auto idx_iter = port_idx.find(port_key(this->src_port,
+											   this->dst_port));
+
+		return (idx_iter == port_idx.end() ? NO_PORT_SLOT : idx_iter->second);
+	}
+
+	auto port_iter = std::find_if(open_ports.begin(), open_ports.end(), 
+							[this](const open_port& port) {
+								return this->comp_ports(port);
+							});
+
+	if (port_iter == open_ports.end()) {
+		return NO_PORT_SLOT;
+	}
+
+	return port_iter - open_ports.begin();
+}
+
+/**
+* @fn bind_nic
+* @brief Binds the packet to a NIC, so it uses the NIC's precomputed
+*		 lookups (e.g. open ports index) instead of deriving them
+*		 from the arguments of validate_packet and proccess_packet.
+* @param nic - The NIC's lookups, must outlive the packet.
+* @return None.
+*/
+void L4::bind_nic(const nic_context* nic) {
+	this->nic = nic;
+}
+
+/**
+* @fn get_layer
+* @brief Getter to the outermost layer of the packet, so callers
+*		 can cast it to its exact class and skip virtual calls.
+* @return The layer.
+*/
+packet_layer L4::get_layer() const {
+	return this->layer;
+}
+
+/**
+* @fn set_layer
+* @brief Setter of the outermost layer, by constructors of
+*		 the classes that extend L4.
+* @param layer - The layer.
+* @return None.
+*/
+void L4::set_layer(packet_layer layer) {
+	this->layer = layer;
+}
+
+/**
+* @fn get_drop_reason
+* @brief Getter to why the packet failed its last check or
+*		 process, for the NIC's stats.
+* @return The reason, DROP_NONE if nothing failed.
+*/
+drop_reason L4::get_drop_reason() const {
+	return this->drop;
+}
+
+/**
+* @fn set_drop_reason
+* @brief Setter of why the packet is dropped, by the checks and
+*		 processes of all layers.
+* @param reason - The reason.
+* @return None.
+*/
+void L4::set_drop_reason(drop_reason reason) {
+	this->drop = reason;
+}
+
+/**
+* @fn string_buffer
+* @brief Getter to the calling thread's buffer that as_string
+*		 formats packets in, so a packet is written into its
+*		 string with a single copy.
+* @return The buffer, empty.
+*/
+out_buffer& L4::string_buffer() {
+	static thread_local out_buffer out;
+
+	out.clear();
+	return out;
+}
+
+/**
+* @fn get_nic
+* @brief A getter to the NIC the packet is bound to.
+* @return The NIC's lookups, nullptr if the packet isn't bound.
+*/
+const nic_context* L4::get_nic() const {
+	return this->nic;
+}
+
+/**
+* @fn port_key
+* @brief Builds the key of a (src, dst) ports pair in open_port_idx.
+* @param src_port - Source port.
+* @param dst_port - Destination port.
+* @return The key of the pair.
+*/
+unsigned int L4::port_key(unsigned short src_port, unsigned short dst_port) {
+	return (static_cast<unsigned int>(src_port) << 16) | dst_port;
+}
+
+/**
+* @fn get_port_key
+* @brief Getter to the key of the packet's ports in open_port_idx.
+* @return The key of the packet's ports.
+*/
+unsigned int L4::get_port_key() const {
+	return port_key(this->src_port, this->dst_port);
+}
+
 /**
 * @fn calc_sum
-* @brief Sums all bytes of each property of the packet.
+* @brief Sums all bytes of each property of the packet. The fields
+*		 of L4 never change, so the sum is taken when the packet is
+*		 created and kept.
 * @return The calculated sum.
 */
 unsigned int L4::calc_sum() const {
+	return this->sum;
+}
+
+/**
+* @fn sum_fields
+* @brief Sums all bytes of each property of the packet, going over
+*		 the whole payload.
+* @return The calculated sum.
+*/
+unsigned int L4::sum_fields() const {
 	unsigned int src_prt_sum = sum_bytes(this->src_port);
 	unsigned int dst_prt_sum = sum_bytes(this->dst_port);
 	unsigned int addr_sum = sum_bytes(this->addr);
@@ -181,25 +388,11 @@ unsigned int L4::calc_sum() const {
 		 each byte (two chars) is converted to it's int value.
 * @param data_str - string of data to convert.
 * @param data_arr[] - array to write to.
-* @return NONE.
+* @return NONE, throws std::invalid_argument if a digit isn't hex.
 */
-void L4::data_to_arr(std::string data_str, unsigned char data_arr[]) {
-	for (int i = 0; i < DATA_L5_SIZE; i++) {
-		// get next byte written in base 16
-		int end_idx = (i == DATA_L5_SIZE - 1? -1 : i);
-		std::string chunk = extract_between_delimiters(data_str,
-														' ',
-														i,
-														end_idx);
-		// convert to int
-		unsigned char dec_num = 0;
-
-		for (int dig = 0; dig < HEX_DIG_IN_BYTE; dig++) {
-			dec_num *= HEX_BASE;
-			dec_num += hex_to_dec(chunk[dig]);
-		}
-
-		data_arr[i] = dec_num;
+void L4::data_to_arr(str_view data_str, unsigned char data_arr[]) {
+	if (!hex_codec::decode(data_str, data_arr, DATA_L5_SIZE)) {
+		throw std::invalid_argument("Malformed hex digit in packet data.");
 	}
 }
 
@@ -212,37 +405,27 @@ void L4::data_to_arr(std::string data_str, unsigned char data_arr[]) {
 * @return the array as a string in hex base.
 */
 std::string L4::arr_dec_to_hex(const unsigned char arr[], int n){
-    std::string hex = "";
-
-    for (int i = 0; i < n - 1; i++) {
-        hex += dec_to_hex(arr[i]) + " ";
-    }
-    hex += dec_to_hex(arr[n - 1]);
+    std::string hex;
+    hex_codec::encode(arr, n, hex);
 
     return hex;
 }
 
 /**
-* @fn dec_to_hex
-* @brief converts number in base 10 to number in base 16.
-* @param dec - char containing the number to convert.
-* @return number in base 16 as a string.
+* @fn field_to_uint
+* @brief Converts a decimal field of a packet to a number.
+* @param field - The field, see packet_tokenizer::to_uint.
+* @param max - Largest number the field may hold.
+* @return The number, throws std::invalid_argument if the field
+*		  isn't a number or is larger than max.
 */
-std::string L4::dec_to_hex(unsigned char dec) {
-
-	int dec_int = static_cast<int>(dec);
-
-	int msb = dec_int / 16;
-	int lsb = dec_int % 16;
-
-	char msb_chr = (msb < 10 ? msb + '0' : (msb - DEC_BASE) + 'a'); 
-	char lsb_chr = (lsb < 10 ? lsb + '0' : (lsb - DEC_BASE) + 'a'); 
-
-	std::string hex_str = "";
-	hex_str += msb_chr;
-	hex_str += lsb_chr;
+unsigned int L4::field_to_uint(str_view field, unsigned int max) {
+	unsigned int num;
+	if (!packet_tokenizer::to_uint(field, num) || num > max) {
+		throw std::invalid_argument("Invalid number in packet.");
+	}
 
-	return hex_str;
+	return num;
 }
 
 /**
@@ -259,16 +442,3 @@ int L4::sum_bytes(unsigned int num) {
     }
     return sum;
 }
-
-/**
-* @fn chr_to_int
-* @brief converts a char represent a digit in hex to int in decimal
-* @param [in] c - the char
-* return the int
-*/
-uint8_t L4::hex_to_dec(char c) {
-    if (c >= '0' && c <= '9') {
-        return c - '0';
-    } 
-    return c - 'a' + DEC_BASE;
-} 
@@ -1,17 +1,25 @@
 #ifndef __L4__
 #define __L4__
 
+#include <array>
+#include <climits>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include "common.hpp"
 #include "packets.hpp"
+#include "packet_record.h"
+#include "tokenizer.h"
+#include "hex_codec.h"
+#include "out_buffer.h"
+#include "nic_stats.h"
 
-/* Size of data in L5 packet */
-const int DATA_L5_SIZE = 32;
 /* Size of byte in bits */
 const int SIZE_OF_BYTE = 8;
 /* Num of hex digit in one byte */
 const int HEX_DIG_IN_BYTE = 2;
+/* Slot value of a packet that was not matched to an open port */
+const int NO_PORT_SLOT = -1;
 
 /* Different sizes of counting bases */
 enum bases_size {
@@ -19,13 +27,40 @@ enum bases_size {
     DEC_BASE = 10
 };
 
+/* Order of the fields in L4 packet */
+enum L4_fields {
+    SRC_PORT_FIELD,
+    DST_PORT_FIELD,
+    ADDR_FIELD,
+    DATA_FIELD,
+    L4_FIELDS_NUM
+};
+
+/* Maps port key (see L4::port_key) to the slot of the port in open_port_vec */
+typedef std::unordered_map<unsigned int, int> open_port_idx;
+
+struct nic_context;
 
 
 class L4: public generic_packet {
 	unsigned short src_port;
 	unsigned short dst_port;
 	unsigned int addr;
-	unsigned char* data;
+	std::array<unsigned char, DATA_L5_SIZE> data;
+
+	/* NIC the packet is bound to, nullptr if there is none */
+	const nic_context* nic;
+	/* Slot of the matching open port, found by validate_packet */
+	int port_slot;
+	/* Sum of the packet's bytes, computed once when it is created */
+	unsigned int sum;
+	/* Outermost layer of the packet, the class it was created as */
+	packet_layer layer;
+	/* Why the last check or process of the packet failed */
+	drop_reason drop;
+
+	/* benchmarks call the parsing and checksum helpers directly */
+	friend class nic_bench;
 
 	public:
 
@@ -40,11 +75,20 @@ class L4: public generic_packet {
 
 		/**
 		* @fn L4
-		* @brief Copy Constructor of the class
-		* @param base - L4 packet to copy.
-		* @return New copy of L4 packet.
+		* @brief Constructor of the class from an already tokenized packet.
+		* @param fields[] - L4_FIELDS_NUM fields of the packet, in order:
+		*		 src_port, dst_port, addrs, L5_data.
+		* @return New L4 packet object.
 		*/
-		L4(const L4 &base);
+		L4(const str_view fields[]);
+
+		/**
+		* @fn L4
+		* @brief Constructor of the class from a packet record.
+		* @param record - The record to take L4 properties from.
+		* @return New L4 packet object.
+		*/
+		L4(const packet_record &record);
 
 		/**
 		* @fn validate_packet
@@ -61,6 +105,20 @@ class L4: public generic_packet {
                              uint8_t mask,
                              uint8_t mac[MAC_SIZE]);
 
+		/**
+		* @fn check_packet
+		* @brief Same as validate_packet, without copying open_ports.
+		* @param open_ports - A vector of all NIC's open ports.
+		* @param ip[] - NIC's IP address, represented via an array.
+		* @param mask - The mask of the NIC's that determine the local net.
+		* @param mac - NIC's MAC address, represented via an array.
+		* @return True upon success, false otherwise. 
+		*/
+		bool check_packet(const open_port_vec &open_ports,
+                          uint8_t ip[IP_V4_SIZE],
+                          uint8_t mask,
+                          uint8_t mac[MAC_SIZE]);
+
 		/**
 		* @fn packet_proccess
 		* @brief Proccess L4 packet as specified.
@@ -83,14 +141,44 @@ class L4: public generic_packet {
 		* @return True upon success, false otherwise.
 		*/
 		bool as_string(std::string &packet);
-		
+
+		/**
+		* @fn write
+		* @brief Same as as_string, appending to a buffer.
+		* @param out[out] - The buffer to append the packet to.
+		* @return None.
+		*/
+		void write(out_buffer &out) const;
+
+		/**
+		* @fn to_record
+		* @brief Writes packet properties into a flat record.
+		* @param record[out] - The record to fill, zeroed first.
+		* @return None.
+		*/
+		void to_record(packet_record &record) const;
+
+		/**
+		* @fn parse_record
+		* @brief Parses a tokenized packet straight into a flat record,
+		*		 without creating a packet object.
+		* @param fields[] - L4_FIELDS_NUM fields of the packet, in order:
+		*		 src_port, dst_port, addrs, L5_data.
+		* @param record[out] - The record to fill, zeroed first.
+		* @return None.
+		*/
+		static void parse_record(const str_view fields[],
+								 packet_record &record);
+
 		/**
-		* @fn ~L4
-		* @brief Destructs L4 object, 
-		*        deletes all dynamically allocated memory.
+		* @fn write_record
+		* @brief Writes an L4 packet record the way as_string writes the
+		*		 packet: "src_port|dst_port|addrs|L5_data".
+		* @param record - The packet record.
+		* @param out[out] - The buffer to append the packet to.
 		* @return None.
 		*/
-		~L4();
+		static void write_record(const packet_record &record, out_buffer &out);
 
 		/**
 		* @fn arr_dec_to_hex
@@ -102,6 +190,49 @@ class L4: public generic_packet {
 		*/
 		static std::string arr_dec_to_hex(const unsigned char arr[], int n);
 
+		/**
+		* @fn bind_nic
+		* @brief Binds the packet to a NIC, so it uses the NIC's precomputed
+		*		 lookups (e.g. open ports index) instead of deriving them
+		*		 from the arguments of validate_packet and proccess_packet.
+		* @param nic - The NIC's lookups, must outlive the packet.
+		* @return None.
+		*/
+		void bind_nic(const nic_context* nic);
+
+		/**
+		* @fn port_key
+		* @brief Builds the key of a (src, dst) ports pair in open_port_idx.
+		* @param src_port - Source port.
+		* @param dst_port - Destination port.
+		* @return The key of the pair.
+		*/
+		static unsigned int port_key(unsigned short src_port,
+									 unsigned short dst_port);
+
+		/**
+		* @fn get_port_key
+		* @brief Getter to the key of the packet's ports in open_port_idx.
+		* @return The key of the packet's ports.
+		*/
+		unsigned int get_port_key() const;
+
+		/**
+		* @fn get_layer
+		* @brief Getter to the outermost layer of the packet, so callers
+		*		 can cast it to its exact class and skip virtual calls.
+		* @return The layer.
+		*/
+		packet_layer get_layer() const;
+
+		/**
+		* @fn get_drop_reason
+		* @brief Getter to why the packet failed its last check or
+		*		 process, for the NIC's stats.
+		* @return The reason, DROP_NONE if nothing failed.
+		*/
+		drop_reason get_drop_reason() const;
+
 
 	protected:
 		
@@ -113,31 +244,87 @@ class L4: public generic_packet {
 		*/
 		bool comp_ports(const open_port& port) const;
 
+		/**
+		* @fn get_nic
+		* @brief A getter to the NIC the packet is bound to.
+		* @return The NIC's lookups, nullptr if the packet isn't bound.
+		*/
+		const nic_context* get_nic() const;
+
+		/**
+		* @fn set_layer
+		* @brief Setter of the outermost layer, by constructors of
+		*		 the classes that extend L4.
+		* @param layer - The layer.
+		* @return None.
+		*/
+		void set_layer(packet_layer layer);
+
+		/**
+		* @fn string_buffer
+		* @brief Getter to the calling thread's buffer that as_string
+		*		 formats packets in, so a packet is written into its
+		*		 string with a single copy.
+		* @return The buffer, empty.
+		*/
+		static out_buffer& string_buffer();
+
+		/**
+		* @fn set_drop_reason
+		* @brief Setter of why the packet is dropped, by the checks and
+		*		 processes of all layers.
+		* @param reason - The reason.
+		* @return None.
+		*/
+		void set_drop_reason(drop_reason reason);
+
+		/**
+		* @fn find_port
+		* @brief Finds the slot of the open port matching the packet's ports.
+		*		 Uses the bound NIC's index if there is one, scans otherwise.
+		* @param open_ports - A vector of all NIC's open ports.
+		* @return The slot in open_ports, NO_PORT_SLOT if there is no match.
+		*/
+		int find_port(const open_port_vec& open_ports) const;
+
 		/**
 		* @fn calc_sum
-		* @brief Sums all bytes of each property of the packet.
+		* @brief Sums all bytes of each property of the packet. The fields
+		*		 of L4 never change, so the sum is taken when the packet is
+		*		 created and kept.
 		* @return The calculated sum.
 		*/
 		unsigned int calc_sum() const;
 
+		/**
+		* @fn sum_fields
+		* @brief Sums all bytes of each property of the packet, going over
+		*		 the whole payload.
+		* @return The calculated sum.
+		*/
+		unsigned int sum_fields() const;
+
 		/**
 		* @fn data_to_arr
 		* @brief converts the string od data to an array of ints.
 				 each byte (two chars) is converted to it's int value.
 		* @param data_str - string of data to convert.
 		* @param data_arr[] - array to write to.
-		* @return NONE.
+		* @return NONE, throws std::invalid_argument if a digit isn't hex.
 		*/
-		static void data_to_arr(std::string data_str,
+		static void data_to_arr(str_view data_str,
 								unsigned char data_arr[]);
 
 		/**
-		* @fn dec_to_hex
-		* @brief converts number in base 10 to number in base 16.
-		* @param dec - char containing the number to convert.
-		* @return number in base 16 as a string.
+		* @fn field_to_uint
+		* @brief Converts a decimal field of a packet to a number.
+		* @param field - The field, see packet_tokenizer::to_uint.
+		* @param max - Largest number the field may hold.
+		* @return The number, throws std::invalid_argument if the field
+		*		  isn't a number or is larger than max.
 		*/
-		static std::string dec_to_hex(unsigned char dec);
+		static unsigned int field_to_uint(str_view field,
+										  unsigned int max = UINT_MAX);
 
 		/**
 	    * @fn sum_bytes
@@ -147,13 +334,5 @@ class L4: public generic_packet {
 	    */
 		static int sum_bytes(unsigned int num);
 
-		/**
-		* @fn chr_to_int
-		* @brief converts a char represent a digit in hex to int in decimal
-		* @param [in] c - the char
-		* return the int
-		*/
-		static uint8_t hex_to_dec(char c);
-
 };
 #endif
\ No newline at end of file
@@ -3,9 +3,27 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <cstdio>
+#include <unistd.h>
 
 using namespace common;
 
+/* Route lines of the param file start with this */
+static const char ROUTE_KEYWORD[] = "route ";
+static const size_t ROUTE_KEYWORD_LEN = sizeof(ROUTE_KEYWORD) - 1;
+/* Lines of more dst MACs to accept start with this */
+static const char MAC_KEYWORD[] = "mac ";
+static const size_t MAC_KEYWORD_LEN = sizeof(MAC_KEYWORD) - 1;
+/* Line of a NIC that accepts broadcast */
+static const char BROADCAST_KEYWORD[] = "broadcast";
+static const size_t BROADCAST_KEYWORD_LEN = sizeof(BROADCAST_KEYWORD) - 1;
+
 /**
 * @fn nic_sim
 * @brief Constructor of the class.
@@ -15,6 +33,11 @@ using namespace common;
 * @return New simulation object.
 */
 nic_sim::nic_sim(std::string param_file) {
+	this->rq_sink = nullptr;
+	this->tq_sink = nullptr;
+	this->rq_queue = nullptr;
+	this->tq_queue = nullptr;
+
 	std::ifstream file(param_file);
 
 	if(!file.is_open()) {
@@ -31,19 +54,47 @@ nic_sim::nic_sim(std::string param_file) {
 		throw std::invalid_argument("No IP address in file");
 	}
 
+	/* lines of a file with CRLF line ends keep the '\r' */
+	if (!mac.empty() && mac.back() == '\r') {
+		mac.pop_back();
+	}
+
 	uint8_t* mac_arr = new uint8_t[MAC_SIZE];
 	L2::mac_to_arr(mac, mac_arr);
 	this->nic_mac = mac_arr;
+	/* a NIC of the broadcast MAC gets broadcast enabled, as it accepts
+	   packets of its own MAC */
+	this->context.macs.add(mac_filter::to_key(mac_arr));
 
 	uint8_t* ip_arr = new uint8_t[IP_V4_SIZE];
 	uint8_t mask = seperate_ip_mask(ip_mask, ip_arr);
 
 	this->nic_ip = ip_arr;
 	this->nic_mask = mask;
+	this->context.local_net = ipv4_subnet(ip_arr, mask);
 
 	std::string port_str;
 
 	while (std::getline(file, port_str)) {
+		if (port_str.compare(0, ROUTE_KEYWORD_LEN, ROUTE_KEYWORD) == 0) {
+			this->add_route(port_str);
+			continue;
+		}
+
+		if (port_str.compare(0, MAC_KEYWORD_LEN, MAC_KEYWORD) == 0) {
+			this->add_mac(port_str);
+			continue;
+		}
+
+		/* lines of a file with CRLF line ends keep the '\r' */
+		if (port_str.compare(0, BROADCAST_KEYWORD_LEN,
+							 BROADCAST_KEYWORD) == 0 &&
+			port_str.find_first_not_of(" \r", BROADCAST_KEYWORD_LEN) ==
+			std::string::npos) {
+			this->context.macs.set_broadcast(true);
+			continue;
+		}
+
 		int curr_idx = 1;
 		while(port_str[curr_idx - 1] != ':') {
 			curr_idx++;
@@ -73,58 +124,669 @@ nic_sim::nic_sim(std::string param_file) {
 		prt = open_port(std::stoi(dst_str), std::stoi(src_str));
 		
 		this->open_ports.push_back(prt);
+
+		/* first port wins on duplicates, same as a linear scan */
+		this->context.port_idx.emplace(L4::port_key(prt.src_prt,
+													prt.dst_prt),
+									   this->open_ports.size() - 1);
 	}
+
+	this->context.routes.build();
 }
 
 /**
 * @fn nic_flow
 * @brief Process and store to relevant location all packets in packet_file.
 *
-* @param packet_file - Name of file containing packets as strings.
+* @param packet_file - Name of file containing packets as strings, one
+*                      per line. Empty lines are skipped.
 *
 * @return None.
 */
 void nic_sim::nic_flow(std::string packet_file) {
-	std::ifstream file(packet_file);
+	packet_reader file(packet_file);
 
-	if(!file.is_open()) {
-		throw std::invalid_argument("Could not open the file.");
+	/* lines are read, parsed to records and handled a block at a time */
+	std::vector<str_view> lines(CHECKSUM_BLOCK_SIZE);
+	std::vector<std::string> lines_copy(file.is_mapped() ?
+										0 : CHECKSUM_BLOCK_SIZE);
+	std::vector<packet_record> &records = this->block.records;
+
+	while (true) {
+		int lines_num;
+		{
+			stage_timer timer(this->stats, STAGE_READ);
+			lines_num = read_lines(file, lines.data(), lines_copy.data(),
+								   CHECKSUM_BLOCK_SIZE);
+		}
+
+		if (lines_num == 0) {
+			break;
+		}
+
+		{
+			stage_timer timer(this->stats, STAGE_PARSE);
+			for (int i = 0; i < lines_num; i++) {
+				this->parse_line(lines[i], records[i]);
+			}
+		}
+
+		this->handle_block(records.data(), lines_num);
 	}
 
-	std::string packet_str;
-	while(std::getline(file, packet_str)) {
-		generic_packet* packet = this->packet_factory(packet_str);
+	this->flush_sinks();
+}
 
-		if (packet->validate_packet(this->open_ports, 
-									this->nic_ip,
-									this->nic_mask,
-									this->nic_mac)) {
+/**
+* @fn nic_flow_binary
+* @brief Same as nic_flow, for a binary trace made by convert_trace.
+*        Packets are loaded as they are, without parsing text.
+*
+* @param trace_file - Name of the binary trace file.
+*
+* @return None.
+*/
+void nic_sim::nic_flow_binary(std::string trace_file) {
+	trace_reader file(trace_file);
 
-			memory_dest dst = LOCAL_DRAM;
+	std::vector<packet_record> records(CHECKSUM_BLOCK_SIZE);
 
-			packet->proccess_packet(this->open_ports, 
-									this->nic_ip,
-									this->nic_mask,
-									dst);
+	while (true) {
+		size_t records_num;
+		{
+			stage_timer timer(this->stats, STAGE_READ);
+			records_num = file.read(records.data(), records.size());
+		}
 
-			std::string packet_str;
-			packet->as_string(packet_str);
+		if (records_num == 0) {
+			break;
+		}
 
-			switch (dst) {
-				case memory_dest::RQ:
-					this->RQ.push_back(packet_str);
-					break;
+		this->handle_block(records.data(), records_num);
+	}
+
+	this->flush_sinks();
+}
+
+/**
+* @fn nic_flow_batch
+* @brief Same as nic_flow, for packet lines already in memory. Packets
+*        go through the flow CHECKSUM_BLOCK_SIZE at a time, each stage
+*        (parse, validate, process, enqueue) running over the whole
+*        block before the next. Sinks are flushed at the end.
+*
+* @param lines[] - The packet lines. Empty lines are skipped.
+* @param lines_num - Num of lines.
+*
+* @return None.
+*/
+void nic_sim::nic_flow_batch(const str_view lines[], size_t lines_num) {
+	std::vector<packet_record> &records = this->block.records;
+	int records_num = 0;
+
+	size_t i = 0;
+	while (i < lines_num) {
+		{
+			stage_timer timer(this->stats, STAGE_PARSE);
+			for (; i < lines_num && records_num < CHECKSUM_BLOCK_SIZE; i++) {
+				if (lines[i].len > 0) {
+					this->parse_line(lines[i], records[records_num++]);
+				}
+			}
+		}
+
+		if (records_num == CHECKSUM_BLOCK_SIZE) {
+			this->handle_block(records.data(), records_num);
+			records_num = 0;
+		}
+	}
+
+	this->handle_block(records.data(), records_num);
+	this->flush_sinks();
+}
+
+/**
+* @fn nic_flow_batch
+* @brief Same as nic_flow_batch, for packets already parsed to records.
+*
+* @param records[] - The packet records.
+* @param records_num - Num of records.
+*
+* @return None.
+*/
+void nic_sim::nic_flow_batch(const packet_record records[],
+							 size_t records_num) {
+	for (size_t first = 0; first < records_num; first += CHECKSUM_BLOCK_SIZE) {
+		size_t block_size = std::min<size_t>(CHECKSUM_BLOCK_SIZE,
+											 records_num - first);
+
+		this->handle_block(records + first, block_size);
+	}
+
+	this->flush_sinks();
+}
+
+/**
+* @fn convert_trace
+* @brief Parses a packets file once and saves it as a binary trace of
+*        fixed size packet records, to be replayed by nic_flow_binary.
+*
+* @param packet_file - Name of file containing packets as strings.
+* @param trace_file - Name of the binary trace file to create.
+*
+* @return Num of packets written to the trace.
+*/
+unsigned long nic_sim::convert_trace(std::string packet_file,
+									 std::string trace_file) {
+	packet_reader file(packet_file);
+	trace_writer trace(trace_file);
+
+	std::vector<packet_record> records(PACKET_BATCH_SIZE);
+	unsigned long packets_num = 0;
+	size_t records_num = 0;
+
+	str_view line;
+	while (file.next_line(line)) {
+		if (line.len == 0) {
+			continue;
+		}
+
+		line_to_record(line, records[records_num++]);
+		packets_num++;
+
+		if (records_num == records.size()) {
+			trace.write(records.data(), records_num);
+			records_num = 0;
+		}
+	}
+
+	trace.write(records.data(), records_num);
+
+	return packets_num;
+}
+
+/**
+* @fn nic_flow
+* @brief Same as nic_flow, with packets handled by workers_num threads.
+*        Packets are sharded by their (src_port, dst_port), so DRAM
+*        writes to each open port keep the order of the file, and
+*        RQ/TQ are filled in file order. Results are the same as the
+*        single threaded run.
+*
+* @param packet_file - Name of file containing packets as strings.
+* @param workers_num - Number of threads, 1 or less runs single threaded.
+*
+* @return None.
+*/
+void nic_sim::nic_flow(std::string packet_file, unsigned int workers_num) {
+	if (workers_num <= 1) {
+		this->nic_flow(packet_file);
+		return;
+	}
+
+	packet_reader file(packet_file);
+
+	/* arena isn't thread safe, each worker parses into its own */
+	std::vector<std::unique_ptr<packet_arena>> arenas;
+	for (unsigned int worker = 0; worker < workers_num; worker++) {
+		arenas.emplace_back(new packet_arena());
+	}
+
+	/* views into a mapped file stay valid, others are copied aside */
+	std::vector<str_view> lines(PARALLEL_BATCH_SIZE);
+	std::vector<std::string> lines_copy(file.is_mapped() ?
+										0 : PARALLEL_BATCH_SIZE);
+	std::vector<L4*> packets(PARALLEL_BATCH_SIZE);
+	std::vector<unsigned int> shards(PARALLEL_BATCH_SIZE);
+	std::vector<memory_dest> dsts(PARALLEL_BATCH_SIZE);
+	std::vector<packet_record> out_records(PARALLEL_BATCH_SIZE);
+
+	while (true) {
+		int lines_num;
+		{
+			stage_timer timer(this->stats, STAGE_READ);
+			lines_num = read_lines(file, lines.data(), lines_copy.data(),
+								   PARALLEL_BATCH_SIZE);
+		}
+
+		if (lines_num == 0) {
+			break;
+		}
+
+		this->stats.count_packets(lines_num);
+
+		/* parse - each worker takes a contiguous range of lines */
+		run_workers(workers_num, [&](unsigned int worker) {
+			int begin = lines_num * worker / workers_num;
+			int end = lines_num * (worker + 1) / workers_num;
+			nic_stats worker_stats;
+
+			{
+				stage_timer timer(worker_stats, STAGE_PARSE);
+				for (int i = begin; i < end; i++) {
+					packets[i] = this->parse_packet(lines[i],
+													*arenas[worker]);
+					shards[i] = flow_shard(packets[i]->get_port_key(),
+										   workers_num);
+					dsts[i] = LOCAL_DRAM;
+				}
+			}
+
+			this->add_stats(worker_stats);
+		});
+
+		/* validate and process - each worker owns the packets of its
+		   ports and handles them in file order. Packets are checked one
+		   by one here, so validation is timed as part of processing. */
+		run_workers(workers_num, [&](unsigned int worker) {
+			nic_stats worker_stats;
+
+			{
+				stage_timer timer(worker_stats, STAGE_PROCESS);
+				for (int i = 0; i < lines_num; i++) {
+					if (shards[i] != worker) {
+						continue;
+					}
+
+					if (!this->process_packet(packets[i], true, dsts[i])) {
+						worker_stats.count_drop(packets[i]->get_drop_reason());
+						continue;
+					}
+
+					worker_stats.count_dst(dsts[i]);
+					if (dsts[i] != LOCAL_DRAM) {
+						record_packet(packets[i], out_records[i]);
+					}
+				}
+			}
+
+			this->add_stats(worker_stats);
+		});
+
+		/* queue in file order */
+		{
+			stage_timer timer(this->stats, STAGE_ENQUEUE);
+			for (int i = 0; i < lines_num; i++) {
+				if (dsts[i] != LOCAL_DRAM) {
+					this->enqueue(dsts[i], out_records[i]);
+				}
+				packets[i]->~L4();
+			}
+		}
+
+		for (auto &worker_arena: arenas) {
+			worker_arena->reset();
+		}
+	}
+
+	this->flush_sinks();
+}
+
+/**
+* @fn nic_flow_pipeline
+* @brief Same as nic_flow, with the stages in their own threads so
+*        reading, parsing, processing and output overlap: the calling
+*        thread reads chunks of lines and hands them round robin to
+*        parsers_num parser threads, one thread validates and processes
+*        the chunks in file order, and one thread writes the packets to
+*        their queues. Stages pass chunks through lock free single
+*        producer single consumer queues. Results are the same as the
+*        single threaded run.
+*
+* @param packet_file - Name of file containing packets as strings.
+* @param parsers_num - Number of parser threads, at least 1.
+*
+* @return None.
+*/
+void nic_sim::nic_flow_pipeline(std::string packet_file,
+								unsigned int parsers_num) {
+	typedef spsc_ring<flow_chunk*> chunk_ring;
+
+	packet_reader file(packet_file);
+	parsers_num = std::max(parsers_num, 1u);
+
+	/* chunks circulate reader -> parser -> processor -> writer -> reader */
+	size_t chunks_num = PIPELINE_CHUNKS_PER_PARSER * parsers_num;
+	std::vector<std::unique_ptr<flow_chunk>> chunks;
+	chunk_ring free_chunks(chunks_num);
+	for (size_t i = 0; i < chunks_num; i++) {
+		chunks.emplace_back(new flow_chunk());
+		free_chunks.try_push(chunks.back().get());
+	}
+
+	std::vector<std::unique_ptr<chunk_ring>> to_parser;
+	std::vector<std::unique_ptr<chunk_ring>> to_processor;
+	for (unsigned int parser = 0; parser < parsers_num; parser++) {
+		to_parser.emplace_back(new chunk_ring(chunks_num));
+		to_processor.emplace_back(new chunk_ring(chunks_num));
+	}
+	chunk_ring to_writer(chunks_num);
+
+	/* first failure of any stage stops all of them */
+	std::atomic<bool> stop(false);
+	std::mutex error_mutex;
+	std::exception_ptr error;
+	auto fail = [&]() {
+		std::lock_guard<std::mutex> lock(error_mutex);
+		if (!error) {
+			error = std::current_exception();
+		}
+		stop = true;
+	};
+
+	std::vector<std::thread> threads;
 
-				case memory_dest::TQ:
-					this->TQ.push_back(packet_str);
+	for (unsigned int parser = 0; parser < parsers_num; parser++) {
+		threads.emplace_back([&, parser]() {
+			nic_stats parser_stats;
+			try {
+				flow_chunk* chunk;
+				while (to_parser[parser]->pop(chunk, stop)) {
+					{
+						stage_timer timer(parser_stats, STAGE_PARSE);
+						for (int i = 0; i < chunk->lines_num; i++) {
+							line_to_record(chunk->lines[i],
+										   chunk->block.records[i]);
+						}
+					}
+					chunk->records_num = chunk->lines_num;
+
+					if (!to_processor[parser]->push(chunk, stop)) {
+						break;
+					}
+				}
+			} catch (...) {
+				fail();
+			}
+			this->add_stats(parser_stats);
+			to_processor[parser]->close();
+		});
+	}
+
+	/* chunk seq went to parser seq % parsers_num, so taking the parsers
+	   in turn rebuilds the file order */
+	threads.emplace_back([&]() {
+		nic_stats processor_stats;
+		try {
+			unsigned long next_seq = 0;
+			flow_chunk* chunk;
+			while (to_processor[next_seq % parsers_num]->pop(chunk, stop)) {
+				if (chunk->seq != next_seq) {
+					throw std::logic_error("Pipeline chunk out of order.");
+				}
+
+				this->process_block(chunk->block,
+									chunk->block.records.data(),
+									chunk->records_num,
+									chunk->arena,
+									processor_stats);
+				next_seq++;
+
+				if (!to_writer.push(chunk, stop)) {
 					break;
+				}
+			}
+		} catch (...) {
+			fail();
+		}
+		this->add_stats(processor_stats);
+		to_writer.close();
+	});
 
-				case memory_dest::LOCAL_DRAM:
+	threads.emplace_back([&]() {
+		nic_stats writer_stats;
+		try {
+			flow_chunk* chunk;
+			while (to_writer.pop(chunk, stop)) {
+				this->enqueue_block(chunk->block, chunk->records_num,
+									writer_stats);
+				release_block(chunk->block, chunk->records_num, chunk->arena);
+
+				if (!free_chunks.push(chunk, stop)) {
 					break;
+				}
+			}
+		} catch (...) {
+			fail();
+		}
+		this->add_stats(writer_stats);
+	});
+
+	/* read - the other threads add their stats to this->stats, so the
+	   reader counts into its own too */
+	nic_stats reader_stats;
+	try {
+		unsigned long seq = 0;
+		bool eof = false;
+		flow_chunk* chunk;
+
+		while (!eof && free_chunks.pop(chunk, stop)) {
+			{
+				stage_timer timer(reader_stats, STAGE_READ);
+				chunk->lines_num = read_lines(file,
+											  chunk->lines.data(),
+											  chunk->lines_copy.data(),
+											  CHECKSUM_BLOCK_SIZE);
+			}
+			eof = (chunk->lines_num < CHECKSUM_BLOCK_SIZE);
+
+			if (chunk->lines_num == 0) {
+				break;
+			}
+
+			chunk->seq = seq;
+			if (!to_parser[seq % parsers_num]->push(chunk, stop)) {
+				break;
 			}
+			seq++;
 		}
+	} catch (...) {
+		fail();
+	}
+
+	for (auto &ring: to_parser) {
+		ring->close();
+	}
 
-		delete packet;
+	for (auto &thread: threads) {
+		thread.join();
+	}
+
+	this->add_stats(reader_stats);
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	this->flush_sinks();
+}
+
+/**
+* @fn set_queue_sinks
+* @brief Streams the packets sent to RQ and TQ to sinks as they are
+*        produced, instead of keeping them until nic_print_results.
+*
+* @param rq_sink - Sink of RQ, nullptr keeps RQ packets in memory.
+* @param tq_sink - Sink of TQ, nullptr keeps TQ packets in memory.
+*
+* @return None.
+*/
+void nic_sim::set_queue_sinks(queue_sink* rq_sink, queue_sink* tq_sink) {
+	this->rq_sink = rq_sink;
+	this->tq_sink = tq_sink;
+}
+
+/**
+* @fn enqueue
+* @brief Sends a processed packet to its destination queue: to the
+*        queue's fixed capacity queue or sink if it has one, otherwise
+*        to RQ/TQ. Only a sink gets the packet as a string.
+*
+* @param dst - Destination of the packet.
+* @param record - The packet, as a record.
+*
+* @return None.
+*/
+void nic_sim::enqueue(memory_dest dst, const packet_record &record) {
+	packet_queue* queue;
+	queue_sink* sink;
+	std::vector<packet_record>* stored;
+
+	switch (dst) {
+		case memory_dest::RQ:
+			queue = this->rq_queue;
+			sink = this->rq_sink;
+			stored = &this->RQ;
+			break;
+
+		case memory_dest::TQ:
+			queue = this->tq_queue;
+			sink = this->tq_sink;
+			stored = &this->TQ;
+			break;
+
+		default:
+			return;
+	}
+
+	if (queue != nullptr) {
+		queue->push(record);
+	} else if (sink != nullptr) {
+		this->sink_out.clear();
+		write_record(record, this->sink_out);
+		this->sink_str.assign(this->sink_out.data(), this->sink_out.size());
+		sink->push(this->sink_str);
+	} else {
+		stored->push_back(record);
+	}
+}
+
+/**
+* @fn set_queue_rings
+* @brief Sends the packets for RQ and TQ, as packet records, to fixed
+*        capacity queues that drop packets when they are full. Takes
+*        precedence over the queue's sink.
+*
+* @param rq_queue - Queue of RQ, nullptr for none.
+* @param tq_queue - Queue of TQ, nullptr for none.
+*
+* @return None.
+*/
+void nic_sim::set_queue_rings(packet_queue* rq_queue, packet_queue* tq_queue) {
+	this->rq_queue = rq_queue;
+	this->tq_queue = tq_queue;
+}
+
+/**
+* @fn set_parse_cache
+* @brief Keeps the records of the last parsed lines, so lines the
+*        trace repeats are not parsed again. Used by packet_factory and
+*        the single threaded flows of lines.
+*
+* @param capacity - Num of lines to keep, 0 removes the cache.
+*
+* @return None.
+*/
+void nic_sim::set_parse_cache(size_t capacity) {
+	if (capacity == 0) {
+		this->cache.reset();
+	} else {
+		this->cache.reset(new parse_cache(capacity));
+	}
+}
+
+/**
+* @fn get_parse_cache_stats
+* @brief Getter to the hit counters of the parse cache.
+*
+* @return The cache's counters, all zeros if there is no cache.
+*/
+parse_cache_stats nic_sim::get_parse_cache_stats() const {
+	if (this->cache == nullptr) {
+		return parse_cache_stats();
+	}
+
+	return this->cache->get_stats();
+}
+
+/**
+* @fn record_to_string
+* @brief Writes a packet record taken from a NIC queue as a string, the
+*        way nic_print_results prints the queues.
+*
+* @param record - The packet record.
+* @param packet[out] - The packet as a string.
+*
+* @return None, throws std::invalid_argument if the layer is unknown.
+*/
+void nic_sim::record_to_string(const packet_record &record,
+							   std::string &packet) {
+	static thread_local out_buffer out;
+
+	out.clear();
+	write_record(record, out);
+	packet.assign(out.data(), out.size());
+}
+
+/**
+* @fn write_record
+* @brief Same as record_to_string, appending to a buffer.
+*
+* @param record - The packet record.
+* @param out[out] - The buffer to append the packet to.
+*
+* @return None, throws std::invalid_argument if the layer is unknown.
+*/
+void nic_sim::write_record(const packet_record &record, out_buffer &out) {
+	switch (record.layer) {
+		case LAYER_L2:
+			L2::write_record(record, out);
+			break;
+
+		case LAYER_L3:
+			L3::write_record(record, out);
+			break;
+
+		case LAYER_L4:
+			L4::write_record(record, out);
+			break;
+
+		default:
+			throw std::invalid_argument("Unknown packet layer.");
+	}
+}
+
+/**
+* @fn add_stats
+* @brief Adds the stats a thread of the parallel flows counted to the
+*        NIC's stats. Safe to call from several threads.
+*
+* @param thread_stats - The thread's stats.
+*
+* @return None.
+*/
+void nic_sim::add_stats(const nic_stats &thread_stats) {
+	if (!nic_stats::enabled) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(this->stats_mutex);
+	this->stats.add(thread_stats);
+}
+
+/**
+* @fn flush_sinks
+* @brief Flushes the sinks of RQ and TQ, if set.
+*
+* @return None.
+*/
+void nic_sim::flush_sinks() {
+	if (this->rq_sink != nullptr) {
+		this->rq_sink->flush();
+	}
+
+	if (this->tq_sink != nullptr) {
+		this->tq_sink->flush();
 	}
 }
 
@@ -143,31 +805,137 @@ void nic_sim::nic_flow(std::string packet_file) {
 *        TQ:
 *        [each packet in separate line]
 *
+*        RQ/TQ keep packet records, they are written as strings only
+*        here. Queues that have a sink or a fixed capacity queue are
+*        empty, their packets were already sent there.
+*
+*        std::cout is flushed first, then the results are written
+*        straight to the stdout descriptor, see fd_writer.
+*
 * @return None.
 */
 void nic_sim::nic_print_results() {
-	std::cout << "LOCAL DRAM:" << std::endl;
+	/* earlier output through the streams must come first */
+	std::cout.flush();
+	fflush(stdout);
+
+	this->nic_print_results(STDOUT_FILENO);
+}
+
+/**
+* @fn nic_print_results
+* @brief Same as nic_print_results, to a file descriptor.
+*
+* @param fd - The descriptor to write to, left open.
+*
+* @return None, throws std::invalid_argument if writing failed.
+*/
+void nic_sim::nic_print_results(int fd) {
+	fd_writer out(fd);
+	this->print_results(out);
+}
+
+/**
+* @fn nic_print_results
+* @brief Same as nic_print_results, to a file.
+*
+* @param file_name - Name of the file to write to, created or truncated.
+*
+* @return None, throws std::invalid_argument if the file can't be
+*         opened or written.
+*/
+void nic_sim::nic_print_results(const std::string &file_name) {
+	fd_writer out(file_name);
+	this->print_results(out);
+}
+
+/**
+* @fn print_results
+* @brief Formats the results of nic_print_results and writes them.
+*
+* @param out - The writer to format the results into, flushed at
+*              the end.
+*
+* @return None.
+*/
+void nic_sim::print_results(fd_writer &out) {
+	stage_timer timer(this->stats, STAGE_SERIALIZE);
+
+	const char dram_title[] = "LOCAL DRAM:\n";
+	out.buffer().append(dram_title, sizeof(dram_title) - 1);
 
 	for (const open_port& prt: this->open_ports) {
-		std::cout << prt.src_prt << " ";
-		std::cout << prt.dst_prt << ": ";
+		out_buffer &line = out.buffer();
 
-		const unsigned char* data_arr = prt.data;
-		
-		std::string data_str = L4::arr_dec_to_hex(data_arr, DATA_ARR_SIZE);
-		std::cout << data_str <<  std::endl;
+		line.append_uint(prt.src_prt);
+		line.append(' ');
+		line.append_uint(prt.dst_prt);
+		line.append(": ", 2);
+		line.append_hex(prt.data, DATA_ARR_SIZE);
+		line.append('\n');
 	}
 
-	std::cout << "\nRQ:" << std::endl;
-	for (std::string entry: this->RQ) {
-		std::cout << entry << std::endl;
+	const char rq_title[] = "\nRQ:\n";
+	out.buffer().append(rq_title, sizeof(rq_title) - 1);
+
+	for (const packet_record &record: this->RQ) {
+		out_buffer &line = out.buffer();
+
+		write_record(record, line);
+		line.append('\n');
 	}
 
-	std::cout << "\nTQ:" << std::endl;
+	const char tq_title[] = "\nTQ:\n";
+	out.buffer().append(tq_title, sizeof(tq_title) - 1);
 
-	for (std::string entry: this->TQ) {
-		std::cout << entry << std::endl;
+	for (const packet_record &record: this->TQ) {
+		out_buffer &line = out.buffer();
+
+		write_record(record, line);
+		line.append('\n');
 	}
+
+	out.flush();
+}
+
+/**
+* @fn get_stats
+* @brief Getter to the counters of the packets the NIC handled, why
+*        packets were dropped and the time spent in each stage of the
+*        flow. All zeros when built with NIC_STATS 0.
+*
+* @return The NIC's stats.
+*/
+const nic_stats& nic_sim::get_stats() const {
+	return this->stats;
+}
+
+/**
+* @fn nic_print_stats
+* @brief Writes the NIC's stats as a JSON object on one line, see
+*        nic_stats::write_json.
+*
+* @param fd - The descriptor to write to, left open.
+*
+* @return None, throws std::invalid_argument if writing failed.
+*/
+void nic_sim::nic_print_stats(int fd) const {
+	fd_writer out(fd);
+
+	this->stats.write_json(out.buffer());
+	out.buffer().append('\n');
+	out.flush();
+}
+
+/**
+* @fn get_arena_stats
+* @brief Getter to the allocation counters of the packet arena, used to
+*        size the arena for a given traffic.
+*
+* @return The arena's counters.
+*/
+const arena_stats& nic_sim::get_arena_stats() const {
+	return this->arena.get_stats();
 }
 
 /**
@@ -188,29 +956,527 @@ nic_sim::~nic_sim() {
 *
 * @param packet - String representation of a packet.
 *
-* @return Pointer to a generic_packet object.
+* @return Pointer to a generic_packet object. The packet lives in the
+*         packet arena, it must be destructed (not deleted) by the
+*         caller before the arena is reset.
 */
 generic_packet* nic_sim::packet_factory(std::string &packet) {
+	if (this->cache == nullptr) {
+		return this->parse_packet(packet, this->arena);
+	}
+
+	packet_record record;
+	this->parse_line(packet, record);
+	return this->create_packet(record, this->arena);
+}
+
+/**
+* @fn parse_packet
+* @brief Creates the packet of the right layer out of a packet line.
+*        Safe to call from several threads, each with its own arena.
+*
+* @param packet - String representation of a packet.
+* @param arena - The arena to create the packet in.
+*
+* @return Pointer to the packet, see packet_factory.
+*/
+L4* nic_sim::parse_packet(str_view packet, packet_arena &arena) const {
+	/* all layers parse their fields out of a single pass over the line */
+	packet_tokenizer tokenizer(packet);
+	const str_view* fields = tokenizer.get_fields();
+
+	switch (classify_packet(packet)) {
+		case LAYER_L2:
+			check_fields_num(tokenizer, MAX_PACKET_FIELDS);
+			return this->create_L2(fields, arena);
+
+		case LAYER_L3:
+			check_fields_num(tokenizer, L3_HEADER_FIELDS + L4_FIELDS_NUM);
+			return this->create_L3(fields, arena);
+
+		default:
+			check_fields_num(tokenizer, L4_FIELDS_NUM);
+			return this->create_L4(fields, arena);
+	}
+}
+
+/**
+* @fn create_packet
+* @brief Creates the packet of the record's layer out of a packet record.
+*
+* @param record - The packet record.
+* @param arena - The arena to create the packet in.
+*
+* @return Pointer to the packet, see packet_factory.
+*/
+L4* nic_sim::create_packet(const packet_record &record,
+						   packet_arena &arena) const {
+	L4* packet;
+
+	switch (record.layer) {
+		case LAYER_L2:
+			packet = arena.create<L2>(record);
+			break;
+
+		case LAYER_L3:
+			packet = arena.create<L3>(record);
+			break;
+
+		case LAYER_L4:
+			packet = arena.create<L4>(record);
+			break;
+
+		default:
+			throw std::invalid_argument("Unknown packet layer.");
+	}
+
+	packet->bind_nic(&this->context);
+	return packet;
+}
+
+/**
+* @fn classify_packet
+* @brief Finds the layer of a packet line from its first entries.
+*
+* @param packet - String representation of a packet.
+*
+* @return The layer of the packet.
+*/
+packet_layer nic_sim::classify_packet(str_view packet) {
 	/* L2 is distinct because of MAC address at first, 
 	   which each entry has fixed size */
-	if (packet[MAC_CLASSIFIER] == ':') {
-		return this->create_L2(packet);
+	if (packet.len > MAC_CLASSIFIER && packet.ptr[MAC_CLASSIFIER] == ':') {
+		return LAYER_L2;
 	}
 
 	/* L3 is distinct because of IP address at first,
 	   which each entry has max size (0-255 so 3) */
-	bool is_L3 = false;
-	for (int i = 0; i <= MAX_IP_SIZE; i++) {
-		if (packet[i] == '.') {
-			is_L3 = true;
+	for (size_t i = 0; i <= MAX_IP_SIZE && i < packet.len; i++) {
+		if (packet.ptr[i] == '.') {
+			return LAYER_L3;
+		}
+	}
+
+	return LAYER_L4;
+}
+
+/**
+* @fn read_lines
+* @brief Reads the next non empty lines of a packets file. Views into
+*        a mapped file stay valid, other lines are copied aside.
+*
+* @param file - The packets file.
+* @param lines[out] - Views of the lines.
+* @param lines_copy[] - Where lines are copied if the file isn't
+*                       mapped, max_lines strings.
+* @param max_lines - Max num of lines to read.
+*
+* @return Num of lines read, 0 at end of file.
+*/
+int nic_sim::read_lines(packet_reader &file,
+						str_view lines[],
+						std::string lines_copy[],
+						int max_lines) {
+	int lines_num = 0;
+	str_view line;
+
+	while (lines_num < max_lines && file.next_line(line)) {
+		if (line.len == 0) {
+			continue;
+		}
+
+		if (!file.is_mapped()) {
+			lines_copy[lines_num].assign(line.ptr, line.len);
+			line = str_view(lines_copy[lines_num]);
 		}
+
+		lines[lines_num++] = line;
+	}
+
+	return lines_num;
+}
+
+/**
+* @fn parse_line
+* @brief Same as line_to_record, through the parse cache if set.
+*
+* @param packet - String representation of a packet.
+* @param record[out] - The record to fill.
+*
+* @return None.
+*/
+void nic_sim::parse_line(str_view packet, packet_record &record) {
+	if (this->cache == nullptr) {
+		line_to_record(packet, record);
+		return;
+	}
+
+	uint64_t hash = parse_cache::hash_line(packet);
+	if (this->cache->find(packet, hash, record)) {
+		return;
 	}
 
-	if(is_L3) {
-		return this->create_L3(packet);
+	/* lines that fail to parse throw before they are cached */
+	line_to_record(packet, record);
+	this->cache->insert(packet, hash, record);
+}
+
+/**
+* @fn line_to_record
+* @brief Parses a packet line straight into a packet record.
+*
+* @param packet - String representation of a packet.
+* @param record[out] - The record to fill.
+*
+* @return None.
+*/
+void nic_sim::line_to_record(str_view packet, packet_record &record) {
+	packet_tokenizer tokenizer(packet);
+	const str_view* fields = tokenizer.get_fields();
+
+	switch (classify_packet(packet)) {
+		case LAYER_L2:
+			check_fields_num(tokenizer, MAX_PACKET_FIELDS);
+			L2::parse_record(fields, record);
+			break;
+
+		case LAYER_L3:
+			check_fields_num(tokenizer, L3_HEADER_FIELDS + L4_FIELDS_NUM);
+			L3::parse_record(fields, record);
+			break;
+
+		default:
+			check_fields_num(tokenizer, L4_FIELDS_NUM);
+			L4::parse_record(fields, record);
+			break;
 	}
+}
 
-	return this->create_L4(packet);
+/**
+* @fn handle_block
+* @brief Runs a block of packets through the stages of the flow:
+*        validates their checksums together, processes the valid ones,
+*        then sends them to their queues.
+*
+* @param records[] - The packets.
+* @param records_num - Num of packets, up to CHECKSUM_BLOCK_SIZE.
+*
+* @return None.
+*/
+void nic_sim::handle_block(const packet_record records[], int records_num) {
+	this->process_block(this->block, records, records_num, this->arena,
+						this->stats);
+	this->enqueue_block(this->block, records_num, this->stats);
+	release_block(this->block, records_num, this->arena);
+}
+
+/**
+* @fn process_block
+* @brief The validate and process stages of handle_block: validates the
+*        checksums of the block together, then creates and processes
+*        the valid packets.
+*
+* @param block - The block's working set, gets the packets and their
+*                destinations.
+* @param records[] - The packets.
+* @param records_num - Num of packets, up to CHECKSUM_BLOCK_SIZE.
+* @param arena - The arena to create the packets in.
+* @param stats - Where the packets, their drops and destinations and
+*                the time of the stages are counted.
+*
+* @return None.
+*/
+void nic_sim::process_block(packet_block &block,
+							const packet_record records[],
+							int records_num,
+							packet_arena &arena,
+							nic_stats &stats) {
+	stats.count_packets(records_num);
+
+	/* validate */
+	uint64_t valid[CHECKSUM_BITMAP_WORDS];
+	{
+		stage_timer timer(stats, STAGE_VALIDATE);
+		block.checksums.load(records, records_num);
+		block.checksums.validate(this->nic_mac, this->context.macs, valid);
+	}
+
+	/* process - checksums of L3 and L2 packets are all their validation,
+	   L4 packets are valid if they match an open port */
+	stage_timer timer(stats, STAGE_PROCESS);
+	for (int i = 0; i < records_num; i++) {
+		block.dsts[i] = LOCAL_DRAM;
+		block.packets[i] = nullptr;
+
+		if (!checksum_block::is_valid(valid, i)) {
+			/* the bitmap doesn't say which check failed */
+			if (nic_stats::enabled) {
+				stats.count_drop(this->invalid_reason(records[i], arena));
+			}
+			continue;
+		}
+
+		L4* packet = this->create_packet(records[i], arena);
+		block.packets[i] = packet;
+
+		if (!this->process_packet(packet, packet->get_layer() == LAYER_L4,
+								  block.dsts[i])) {
+			stats.count_drop(packet->get_drop_reason());
+			continue;
+		}
+
+		stats.count_dst(block.dsts[i]);
+	}
+}
+
+/**
+* @fn enqueue_block
+* @brief The last stage of handle_block: sends the packets leaving the
+*        NIC to their queues, in order.
+*
+* @param block - The block's working set, after process_block.
+* @param records_num - Num of packets in the block.
+* @param stats - Where the time of the stage is counted.
+*
+* @return None.
+*/
+void nic_sim::enqueue_block(packet_block &block,
+							int records_num,
+							nic_stats &stats) {
+	stage_timer timer(stats, STAGE_ENQUEUE);
+	packet_record record;
+
+	for (int i = 0; i < records_num; i++) {
+		if (block.dsts[i] == LOCAL_DRAM) {
+			continue;
+		}
+
+		record_packet(block.packets[i], record);
+		this->enqueue(block.dsts[i], record);
+	}
+}
+
+/**
+* @fn release_block
+* @brief Destructs the packets of a block and releases their memory.
+*
+* @param block - The block's working set, after enqueue_block.
+* @param records_num - Num of packets in the block.
+* @param arena - The arena the packets were created in.
+*
+* @return None.
+*/
+void nic_sim::release_block(packet_block &block,
+							int records_num,
+							packet_arena &arena) {
+	/* packets live in the arena, memory is released per block */
+	for (int i = 0; i < records_num; i++) {
+		if (block.packets[i] != nullptr) {
+			block.packets[i]->~L4();
+		}
+	}
+
+	arena.reset();
+}
+
+/**
+* @fn process_as
+* @brief Checks and processes a packet. Calls are qualified by the
+*        packet's exact class, so they are bound at compile time
+*        instead of through the vtable.
+*
+* @param packet - The packet, as its exact class.
+* @param check - Whether to check the packet before processing it.
+* @param dst[out] - Where the packet should be written in, LOCAL_DRAM if
+*                   the packet was dropped.
+*
+* @return True if the packet passed, false if it was dropped. The
+*         packet's drop reason tells why.
+*/
+template <class packet_t>
+bool nic_sim::process_as(packet_t* packet, bool check, memory_dest &dst) {
+	if (check && !packet->packet_t::check_packet(this->open_ports,
+												 this->nic_ip,
+												 this->nic_mask,
+												 this->nic_mac)) {
+		return false;
+	}
+
+	return packet->packet_t::proccess_packet(this->open_ports,
+											 this->nic_ip,
+											 this->nic_mask,
+											 dst);
+}
+
+/**
+* @fn process_packet
+* @brief Checks and processes a packet as its exact class, see
+*        process_as.
+*
+* @param packet - The packet to process.
+* @param check - Whether to check the packet before processing it.
+* @param dst[out] - Where the packet should be written in.
+*
+* @return True if the packet passed, false if it was dropped.
+*/
+bool nic_sim::process_packet(L4* packet, bool check, memory_dest &dst) {
+	switch (packet->get_layer()) {
+		case LAYER_L2:
+			return this->process_as(static_cast<L2*>(packet), check, dst);
+
+		case LAYER_L3:
+			return this->process_as(static_cast<L3*>(packet), check, dst);
+
+		default:
+			return this->process_as(packet, check, dst);
+	}
+}
+
+/**
+* @fn invalid_reason
+* @brief Finds why a packet failed the block's checksum validation,
+*        by running the checks of its layer on it.
+*
+* @param record - The packet.
+* @param arena - The arena to create the packet in.
+*
+* @return The reason the packet is dropped.
+*/
+drop_reason nic_sim::invalid_reason(const packet_record &record,
+									packet_arena &arena) const {
+	L4* packet = this->create_packet(record, arena);
+
+	/* L2 packets are checked by their L3 header too, as in processing */
+	switch (packet->get_layer()) {
+		case LAYER_L2:
+			if (static_cast<L2*>(packet)->L2::check_packet(this->open_ports,
+														   this->nic_ip,
+														   this->nic_mask,
+														   this->nic_mac)) {
+				static_cast<L2*>(packet)->L3::check_packet(this->open_ports,
+														   this->nic_ip,
+														   this->nic_mask,
+														   nullptr);
+			}
+			break;
+
+		case LAYER_L3:
+			static_cast<L3*>(packet)->L3::check_packet(this->open_ports,
+													   this->nic_ip,
+													   this->nic_mask,
+													   this->nic_mac);
+			break;
+
+		default:
+			packet->L4::check_packet(this->open_ports,
+									 this->nic_ip,
+									 this->nic_mask,
+									 this->nic_mac);
+			break;
+	}
+
+	drop_reason reason = packet->get_drop_reason();
+	packet->~L4();
+
+	return reason;
+}
+
+/**
+* @fn record_packet
+* @brief Writes a packet into a flat record as its exact class, with
+*        calls bound at compile time as in process_as.
+*
+* @param packet - The packet.
+* @param record[out] - The record to fill.
+*
+* @return None.
+*/
+void nic_sim::record_packet(const L4* packet, packet_record &record) {
+	switch (packet->get_layer()) {
+		case LAYER_L2:
+			static_cast<const L2*>(packet)->L2::to_record(record);
+			break;
+
+		case LAYER_L3:
+			static_cast<const L3*>(packet)->L3::to_record(record);
+			break;
+
+		default:
+			packet->L4::to_record(record);
+			break;
+	}
+}
+
+/**
+* @fn check_fields_num
+* @brief Makes sure a tokenized packet has all the fields of its layer.
+* @param tokenizer - The tokenized packet.
+* @param fields_num - Number of fields the packet's layer has.
+* @return None, throws std::invalid_argument if fields are missing.
+*/
+void nic_sim::check_fields_num(const packet_tokenizer &tokenizer,
+							   int fields_num) {
+	if (tokenizer.size() < fields_num) {
+		throw std::invalid_argument("Missing fields in packet.");
+	}
+}
+
+/**
+* @fn flow_shard
+* @brief Picks the worker that owns all packets of a ports pair, so
+*        writes to the same open port stay in order.
+*
+* @param port_key - Key of the packet's ports, see L4::port_key.
+* @param workers_num - Number of workers.
+*
+* @return The worker, in [0, workers_num).
+*/
+unsigned int nic_sim::flow_shard(unsigned int port_key,
+								 unsigned int workers_num) {
+	/* multiplicative hash, its high bits are scaled to the range */
+	uint32_t hash = port_key * 2654435761u;
+	return (static_cast<uint64_t>(hash) * workers_num) >> 32;
+}
+
+/**
+* @fn run_workers
+* @brief Runs work on workers_num threads (the calling thread is
+*        worker 0) and waits for all of them. An exception thrown by
+*        a worker is rethrown once all workers are done.
+*
+* @param workers_num - Number of workers.
+* @param work - Function to run, gets the index of the worker.
+*
+* @return None.
+*/
+void nic_sim::run_workers(unsigned int workers_num,
+						  const std::function<void(unsigned int)> &work) {
+	std::vector<std::exception_ptr> errors(workers_num);
+
+	auto guarded_work = [&](unsigned int worker) {
+		try {
+			work(worker);
+		} catch (...) {
+			errors[worker] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int worker = 1; worker < workers_num; worker++) {
+		threads.emplace_back(guarded_work, worker);
+	}
+
+	guarded_work(0);
+
+	for (std::thread &thread: threads) {
+		thread.join();
+	}
+
+	for (std::exception_ptr &error: errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
 }
 
 /**
@@ -219,9 +1485,14 @@ generic_packet* nic_sim::packet_factory(std::string &packet) {
 * @param ip_mask - the string of ip and mask. format:
                   "ip/mask".
 * @param ip_arr = the array to write the ip into.
-* @return the mask as an int.
+* @return the mask as an int, throws std::invalid_argument if there
+          is no mask.
 */
 uint8_t nic_sim::seperate_ip_mask(std::string ip_mask, uint8_t* ip_arr) {
+	if (ip_mask.find('/') == std::string::npos) {
+		throw std::invalid_argument("No mask in \"ip/mask\".");
+	}
+
 	int idx_sep = 0;
 	while(ip_mask[idx_sep++] != '/');
 
@@ -234,68 +1505,136 @@ uint8_t nic_sim::seperate_ip_mask(std::string ip_mask, uint8_t* ip_arr) {
 	return std::stoi(mask);
 }
 
+/**
+* @fn add_route
+* @brief Adds a route line of the param file to the NIC's routes.
+* @param route - The line, format: "route <ip>/<prefix_len> <action>",
+                 action is one of "rq", "tq" or "drop". The ip's bits
+                 past prefix_len must be 0.
+* @return None, throws std::invalid_argument if the line is invalid.
+*/
+void nic_sim::add_route(const std::string &route) {
+	size_t prefix_start = route.find_first_not_of(' ', ROUTE_KEYWORD_LEN);
+	size_t prefix_end = route.find(' ', prefix_start);
+	size_t action_start = route.find_first_not_of(' ', prefix_end);
+
+	if (prefix_start == std::string::npos ||
+		action_start == std::string::npos) {
+		throw std::invalid_argument("Invalid route line.");
+	}
+
+	std::string prefix_str = route.substr(prefix_start,
+										  prefix_end - prefix_start);
+	size_t slash = prefix_str.find('/');
+	if (slash == std::string::npos) {
+		throw std::invalid_argument("Invalid route line.");
+	}
+
+	/* the length is checked whole before it's narrowed, so /288 isn't
+	   taken as /32 */
+	std::string len_str = prefix_str.substr(slash + 1);
+	if (len_str.empty() || len_str.size() > 2 ||
+		len_str.find_first_not_of("0123456789") != std::string::npos) {
+		throw std::invalid_argument("Invalid route line.");
+	}
+
+	int prefix_len = std::stoi(len_str);
+	if (prefix_len > ROUTE_MAX_PREFIX_LEN) {
+		throw std::invalid_argument("Invalid route line.");
+	}
+
+	uint8_t prefix_arr[IP_V4_SIZE];
+	L3::ip_to_arr(prefix_str.substr(0, slash), prefix_arr);
+
+	/* a prefix with host bits set is more likely a typo than a route */
+	uint32_t prefix = ipv4_subnet::ip_to_uint(prefix_arr);
+	if (prefix & ~route_table::prefix_mask(prefix_len)) {
+		throw std::invalid_argument("Invalid route line.");
+	}
+
+	/* lines of a file with CRLF line ends keep the '\r' */
+	size_t action_end = route.find_first_of(" \r", action_start);
+	if (route.find_first_not_of(" \r", action_end) != std::string::npos) {
+		throw std::invalid_argument("Invalid route line.");
+	}
+
+	std::string action = route.substr(action_start,
+									  action_end - action_start);
+
+	this->context.routes.add(prefix,
+							 prefix_len,
+							 route_table::parse_action(action));
+}
+
+/**
+* @fn add_mac
+* @brief Adds a MAC line of the param file to the dst MACs the NIC
+*        accepts.
+* @param mac - The line, format: "mac xx:xx:xx:xx:xx:xx".
+* @return None, throws std::invalid_argument if the line is invalid.
+*/
+void nic_sim::add_mac(const std::string &mac) {
+	size_t mac_start = mac.find_first_not_of(' ', MAC_KEYWORD_LEN);
+	size_t mac_end = mac.find_first_of(" \r", mac_start);
+
+	if (mac_start == std::string::npos ||
+		mac.find_first_not_of(" \r", mac_end) != std::string::npos) {
+		throw std::invalid_argument("Invalid MAC line.");
+	}
+
+	uint8_t mac_arr[MAC_SIZE];
+	L2::mac_to_arr(mac.substr(mac_start, mac_end - mac_start), mac_arr);
+
+	uint64_t key = mac_filter::to_key(mac_arr);
+	if (key == MAC_BROADCAST_KEY) {
+		throw std::invalid_argument("Broadcast is accepted by a "
+									"\"broadcast\" line.");
+	}
+
+	this->context.macs.add(key);
+}
+
 /**
 * @fn create_L4
-* @brief creates an object L4 from string.
-* @param packet - string representing the packet. format:
+* @brief creates an object L4 from the tokenized packet.
+* @param fields - fields of the packet, split by '|'. format:
                   "src_port|dst_port|addrs|L5_data".
+* @param arena - the arena to create the packet in.
 * @return pointer to L4 packet.
 */
-L4* nic_sim::create_L4(std::string &packet) {
-	L4* L4_packet = new L4(packet);
+L4* nic_sim::create_L4(const str_view fields[],
+						  packet_arena &arena) const {
+	L4* L4_packet = arena.create<L4>(fields);
+	L4_packet->bind_nic(&this->context);
 	return L4_packet;
 }
 
 /**
 * @fn create_L3
-* @brief creates an object L3 from string.
-* @param packet - string representing the packet. format:
+* @brief creates an object L3 from the tokenized packet.
+* @param fields - fields of the packet, split by '|'. format:
                   "src_ip|dst_ip|ttl|cs|L4_packet".
+* @param arena - the arena to create the packet in.
 * @return pointer to L3 packet.
 */
-L3* nic_sim::create_L3(std::string &packet) {
-
-	int idx_sep = 0;
-	int bar_cnt = 0;
-
-	while(bar_cnt < L3_BAR_NUM) { bar_cnt += (packet[idx_sep++] == '|'); };
-
-	std::string L3_str = packet.substr(0, idx_sep - 1);
-	std::string L4_str = packet.substr(idx_sep);
-
-	L4* L4_packet = this->create_L4(L4_str);
-	L3* L3_packet = new L3(*L4_packet, L3_str);
-
-	delete L4_packet;
-
+L3* nic_sim::create_L3(const str_view fields[],
+						  packet_arena &arena) const {
+	L3* L3_packet = arena.create<L3>(fields);
+	L3_packet->bind_nic(&this->context);
 	return L3_packet;
 }
 
 /**
 * @fn create_L2
-* @brief creates an object L2 from string.
-* @param packet - string representing the packet. format:
+* @brief creates an object L2 from the tokenized packet.
+* @param fields - fields of the packet, split by '|'. format:
                   "src_mac|dst_mac|L3_packet|cs".
+* @param arena - the arena to create the packet in.
 * @return pointer to L2 packet.
 */
-L2* nic_sim::create_L2(std::string &packet) {
-	int idx_sep = 0;
-	int bar_cnt = 0;
-
-	while(bar_cnt < L2_BAR_NUM) { bar_cnt += (packet[idx_sep++] == '|'); };
-
-	std::string L3_str = packet.substr(idx_sep);
-
-	int cs_l2_length = 0;
-	while (packet[packet.length() - cs_l2_length] != '|') { cs_l2_length++; };
-
-	L3_str = L3_str.substr(0, L3_str.length() - cs_l2_length);
-
-
-	L3* L3_packet = this->create_L3(L3_str);
-	L2* L2_packet = new L2(*L3_packet, packet);
-
-	delete L3_packet;
-
+L2* nic_sim::create_L2(const str_view fields[],
+						  packet_arena &arena) const {
+	L2* L2_packet = arena.create<L2>(fields);
+	L2_packet->bind_nic(&this->context);
 	return L2_packet;
 }
\ No newline at end of file
@@ -17,22 +17,99 @@
 #include "L2.h"
 #include "L3.h"
 #include "L4.h"
+#include "nic_context.h"
+#include "tokenizer.h"
+#include "packet_arena.h"
+#include "queue_sink.h"
+#include "packet_reader.h"
+#include "packet_trace.h"
+#include "checksum_block.h"
+#include "spsc_ring.h"
+#include "packet_queue.h"
+#include "out_buffer.h"
+#include "fd_writer.h"
+#include "nic_stats.h"
+#include "parse_cache.h"
+#include <functional>
+#include <memory>
+#include <mutex>
 
 enum packets_properties {
-    MAC_CLASSIFIER = 2,
-    L3_BAR_NUM = 4,
-    L2_BAR_NUM = 2
+    MAC_CLASSIFIER = 2
+};
+
+/* Num of packet records convert_trace writes at once */
+const int PACKET_BATCH_SIZE = 1024;
+/* Num of packets the multithreaded nic_flow reads before handing them out */
+const int PARALLEL_BATCH_SIZE = 16384;
+
+/* Working set of one block of packets, kept between blocks so its
+   buffers are reused. Each stage of the flow fills one of the arrays
+   for the whole block before the next stage starts. */
+struct packet_block {
+    /* packets parsed from lines, when the block was given as lines */
+    std::vector<packet_record> records;
+    /* validity bitmap of the block's checksums */
+    checksum_block checksums;
+    /* packet objects of the valid packets, nullptr for the others */
+    std::vector<L4*> packets;
+    /* where each packet was sent by processing */
+    std::vector<memory_dest> dsts;
+
+    packet_block(): records(CHECKSUM_BLOCK_SIZE),
+                    packets(CHECKSUM_BLOCK_SIZE),
+                    dsts(CHECKSUM_BLOCK_SIZE) {}
+};
+
+/* Num of chunks in flight per parser thread of the pipelined nic_flow */
+const int PIPELINE_CHUNKS_PER_PARSER = 4;
+
+/* A chunk of the packets file passed between the threads of the pipelined
+   nic_flow. Only the thread that popped it from a queue touches it. */
+struct flow_chunk {
+    /* position of the chunk in the file, chunks are queued in this order */
+    unsigned long seq;
+    /* non empty lines of the chunk, views into the file or lines_copy */
+    int lines_num;
+    std::vector<str_view> lines;
+    std::vector<std::string> lines_copy;
+    /* num of packets parsed into block.records */
+    int records_num;
+    packet_block block;
+    /* memory of the chunk's packets */
+    packet_arena arena;
+
+    flow_chunk(): seq(0),
+                  lines_num(0),
+                  lines(CHECKSUM_BLOCK_SIZE),
+                  lines_copy(CHECKSUM_BLOCK_SIZE),
+                  records_num(0) {}
 };
 
 class nic_sim {
+    /* benchmarks call packet_factory and line_to_record directly */
+    friend class nic_bench;
+    /* the rack parses packets once and hands blocks of them to its NICs */
+    friend class nic_rack;
+
     public:
     /**
      * @fn nic_sim
      * @brief Constructor of the class.
+     *
+     *        Lines after the MAC and "ip/mask" are open ports,
+     *        "src:<port>,dst:<port>", or routes of L3 packets by their dst
+     *        IP, "route <ip>/<prefix_len> <rq|tq|drop>". The longest
+     *        matching route decides where an L3 packet goes, packets no
+     *        route matches go by the local net. L2 packets are accepted
+     *        by their dst MAC: the NIC's, others added by "mac <mac>"
+     *        lines, unicast or multicast, and ff:ff:ff:ff:ff:ff if there
+     *        is a "broadcast" line.
      * 
      * @param param_file - File name containing the NIC's parameters.
      *
-     * @return New simulation object.
+     * @return New simulation object, throws std::invalid_argument if the
+     *         file can't be read or a line is invalid.
      */
     nic_sim(std::string param_file);
 
@@ -40,12 +117,95 @@ class nic_sim {
      * @fn nic_flow
      * @brief Process and store to relevant location all packets in packet_file.
      *
-     * @param packet_file - Name of file containing packets as strings.
+     * @param packet_file - Name of file containing packets as strings, one
+     *                      per line. Empty lines are skipped.
      *
      * @return None.
      */
     void nic_flow(std::string packet_file);
 
+    /**
+     * @fn nic_flow
+     * @brief Same as nic_flow, with packets handled by workers_num threads.
+     *        Packets are sharded by their (src_port, dst_port), so DRAM
+     *        writes to each open port keep the order of the file, and
+     *        RQ/TQ are filled in file order. Results are the same as the
+     *        single threaded run.
+     *
+     * @param packet_file - Name of file containing packets as strings.
+     * @param workers_num - Number of threads, 1 or less runs single threaded.
+     *
+     * @return None.
+     */
+    void nic_flow(std::string packet_file, unsigned int workers_num);
+
+    /**
+     * @fn nic_flow_pipeline
+     * @brief Same as nic_flow, with the stages in their own threads so
+     *        reading, parsing, processing and output overlap: the calling
+     *        thread reads chunks of lines and hands them round robin to
+     *        parsers_num parser threads, one thread validates and processes
+     *        the chunks in file order, and one thread writes the packets to
+     *        their queues. Stages pass chunks through lock free single
+     *        producer single consumer queues. Results are the same as the
+     *        single threaded run.
+     *
+     * @param packet_file - Name of file containing packets as strings.
+     * @param parsers_num - Number of parser threads, at least 1.
+     *
+     * @return None.
+     */
+    void nic_flow_pipeline(std::string packet_file, unsigned int parsers_num);
+
+    /**
+     * @fn nic_flow_binary
+     * @brief Same as nic_flow, for a binary trace made by convert_trace.
+     *        Packets are loaded as they are, without parsing text.
+     *
+     * @param trace_file - Name of the binary trace file.
+     *
+     * @return None.
+     */
+    void nic_flow_binary(std::string trace_file);
+
+    /**
+     * @fn nic_flow_batch
+     * @brief Same as nic_flow, for packet lines already in memory. Packets
+     *        go through the flow CHECKSUM_BLOCK_SIZE at a time, each stage
+     *        (parse, validate, process, enqueue) running over the whole
+     *        block before the next. Sinks are flushed at the end.
+     *
+     * @param lines[] - The packet lines. Empty lines are skipped.
+     * @param lines_num - Num of lines.
+     *
+     * @return None.
+     */
+    void nic_flow_batch(const str_view lines[], size_t lines_num);
+
+    /**
+     * @fn nic_flow_batch
+     * @brief Same as nic_flow_batch, for packets already parsed to records.
+     *
+     * @param records[] - The packet records.
+     * @param records_num - Num of records.
+     *
+     * @return None.
+     */
+    void nic_flow_batch(const packet_record records[], size_t records_num);
+
+    /**
+     * @fn convert_trace
+     * @brief Parses a packets file once and saves it as a binary trace of
+     *        fixed size packet records, to be replayed by nic_flow_binary.
+     *
+     * @param packet_file - Name of file containing packets as strings.
+     * @param trace_file - Name of the binary trace file to create.
+     *
+     * @return Num of packets written to the trace.
+     */
+    static unsigned long convert_trace(std::string packet_file,
+                                       std::string trace_file);
+
     /**
      * @fn nic_print_results
      * @brief Prints all data stored in memory to stdout in the following format:
@@ -61,10 +221,137 @@ class nic_sim {
      *        TQ:
      *        [each packet in separate line]
      *
+     *        RQ/TQ keep packet records, they are written as strings only
+     *        here. Queues that have a sink or a fixed capacity queue are
+     *        empty, their packets were already sent there.
+     *
+     *        std::cout is flushed first, then the results are written
+     *        straight to the stdout descriptor, see fd_writer.
+     *
      * @return None.
      */
     void nic_print_results();
 
+    /**
+     * @fn nic_print_results
+     * @brief Same as nic_print_results, to a file descriptor.
+     *
+     * @param fd - The descriptor to write to, left open.
+     *
+     * @return None, throws std::invalid_argument if writing failed.
+     */
+    void nic_print_results(int fd);
+
+    /**
+     * @fn nic_print_results
+     * @brief Same as nic_print_results, to a file.
+     *
+     * @param file_name - Name of the file to write to, created or truncated.
+     *
+     * @return None, throws std::invalid_argument if the file can't be
+     *         opened or written.
+     */
+    void nic_print_results(const std::string &file_name);
+
+    /**
+     * @fn set_queue_sinks
+     * @brief Streams the packets sent to RQ and TQ to sinks as they are
+     *        produced, instead of keeping them until nic_print_results.
+     *
+     * @param rq_sink - Sink of RQ, nullptr keeps RQ packets in memory.
+     * @param tq_sink - Sink of TQ, nullptr keeps TQ packets in memory.
+     *
+     * @return None.
+     */
+    void set_queue_sinks(queue_sink* rq_sink, queue_sink* tq_sink);
+
+    /**
+     * @fn set_queue_rings
+     * @brief Sends the packets for RQ and TQ, as packet records, to fixed
+     *        capacity queues that drop packets when they are full. Takes
+     *        precedence over the queue's sink.
+     *
+     * @param rq_queue - Queue of RQ, nullptr for none.
+     * @param tq_queue - Queue of TQ, nullptr for none.
+     *
+     * @return None.
+     */
+    void set_queue_rings(packet_queue* rq_queue, packet_queue* tq_queue);
+
+    /**
+     * @fn set_parse_cache
+     * @brief Keeps the records of the last parsed lines, so lines the
+     *        trace repeats are not parsed again. Used by packet_factory and
+     *        the single threaded flows of lines.
+     *
+     * @param capacity - Num of lines to keep, 0 removes the cache.
+     *
+     * @return None.
+     */
+    void set_parse_cache(size_t capacity = DEFAULT_PARSE_CACHE_SIZE);
+
+    /**
+     * @fn get_parse_cache_stats
+     * @brief Getter to the hit counters of the parse cache.
+     *
+     * @return The cache's counters, all zeros if there is no cache.
+     */
+    parse_cache_stats get_parse_cache_stats() const;
+
+    /**
+     * @fn record_to_string
+     * @brief Writes a packet record taken from a NIC queue as a string, the
+     *        way nic_print_results prints the queues.
+     *
+     * @param record - The packet record.
+     * @param packet[out] - The packet as a string.
+     *
+     * @return None, throws std::invalid_argument if the layer is unknown.
+     */
+    static void record_to_string(const packet_record &record,
+                                 std::string &packet);
+
+    /**
+     * @fn write_record
+     * @brief Same as record_to_string, appending to a buffer.
+     *
+     * @param record - The packet record.
+     * @param out[out] - The buffer to append the packet to.
+     *
+     * @return None, throws std::invalid_argument if the layer is unknown.
+     */
+    static void write_record(const packet_record &record, out_buffer &out);
+
+    /**
+     * @fn get_stats
+     * @brief Getter to the counters of the packets the NIC handled, why
+     *        packets were dropped and the time spent in each stage of the
+     *        flow. All zeros when built with NIC_STATS 0.
+     *
+     * @return The NIC's stats.
+     */
+    const nic_stats& get_stats() const;
+
+    /**
+     * @fn nic_print_stats
+     * @brief Writes the NIC's stats as a JSON object on one line, see
+     *        nic_stats::write_json.
+     *
+     * @param fd - The descriptor to write to, left open.
+     *
+     * @return None, throws std::invalid_argument if writing failed.
+     */
+    void nic_print_stats(int fd) const;
+
+    /**
+     * @fn get_arena_stats
+     * @brief Getter to the allocation counters of the packet arena, used to
+     *        size the arena for a given traffic.
+     *
+     * @return The arena's counters.
+     */
+    const arena_stats& get_arena_stats() const;
+
     /**
      * @fn ~nic_sim
      * @brief Destructor of the class.
@@ -81,18 +368,308 @@ class nic_sim {
      *
      * @param packet - String representation of a packet.
      *
-     * @return Pointer to a generic_packet object.
+     * @return Pointer to a generic_packet object. The packet lives in the
+     *         packet arena, it must be destructed (not deleted) by the
+     *         caller before the arena is reset.
      */
     generic_packet *packet_factory(std::string &packet);
 
+    /**
+     * @fn parse_packet
+     * @brief Creates the packet of the right layer out of a packet line.
+     *        Safe to call from several threads, each with its own arena.
+     *
+     * @param packet - String representation of a packet.
+     * @param arena - The arena to create the packet in.
+     *
+     * @return Pointer to the packet, see packet_factory.
+     */
+    L4 *parse_packet(str_view packet, packet_arena &arena) const;
+
+    /**
+     * @fn create_packet
+     * @brief Creates the packet of the record's layer out of a packet record.
+     *
+     * @param record - The packet record.
+     * @param arena - The arena to create the packet in.
+     *
+     * @return Pointer to the packet, see packet_factory.
+     */
+    L4 *create_packet(const packet_record &record, packet_arena &arena) const;
+
+    /**
+     * @fn classify_packet
+     * @brief Finds the layer of a packet line from its first entries.
+     *
+     * @param packet - String representation of a packet.
+     *
+     * @return The layer of the packet.
+     */
+    static packet_layer classify_packet(str_view packet);
+
+    /**
+     * @fn read_lines
+     * @brief Reads the next non empty lines of a packets file. Views into
+     *        a mapped file stay valid, other lines are copied aside.
+     *
+     * @param file - The packets file.
+     * @param lines[out] - Views of the lines.
+     * @param lines_copy[] - Where lines are copied if the file isn't
+     *                       mapped, max_lines strings.
+     * @param max_lines - Max num of lines to read.
+     *
+     * @return Num of lines read, 0 at end of file.
+     */
+    static int read_lines(packet_reader &file,
+                          str_view lines[],
+                          std::string lines_copy[],
+                          int max_lines);
+
+    /**
+     * @fn parse_line
+     * @brief Same as line_to_record, through the parse cache if set.
+     *
+     * @param packet - String representation of a packet.
+     * @param record[out] - The record to fill.
+     *
+     * @return None.
+     */
+    void parse_line(str_view packet, packet_record &record);
+
+    /**
+     * @fn line_to_record
+     * @brief Parses a packet line straight into a packet record.
+     *
+     * @param packet - String representation of a packet.
+     * @param record[out] - The record to fill.
+     *
+     * @return None.
+     */
+    static void line_to_record(str_view packet, packet_record &record);
+
+    /**
+     * @fn handle_block
+     * @brief Runs a block of packets through the stages of the flow:
+     *        validates their checksums together, processes the valid ones,
+     *        then sends them to their queues.
+     *
+     * @param records[] - The packets.
+     * @param records_num - Num of packets, up to CHECKSUM_BLOCK_SIZE.
+     *
+     * @return None.
+     */
+    void handle_block(const packet_record records[], int records_num);
+
+    /**
+     * @fn process_block
+     * @brief The validate and process stages of handle_block: validates the
+     *        checksums of the block together, then creates and processes
+     *        the valid packets.
+     *
+     * @param block - The block's working set, gets the packets and their
+     *                destinations.
+     * @param records[] - The packets.
+     * @param records_num - Num of packets, up to CHECKSUM_BLOCK_SIZE.
+     * @param arena - The arena to create the packets in.
+     * @param stats - Where the packets, their drops and destinations and
+     *                the time of the stages are counted.
+     *
+     * @return None.
+     */
+    void process_block(packet_block &block,
+                       const packet_record records[],
+                       int records_num,
+                       packet_arena &arena,
+                       nic_stats &stats);
+
+    /**
+     * @fn enqueue_block
+     * @brief The last stage of handle_block: sends the packets leaving the
+     *        NIC to their queues, in order.
+     *
+     * @param block - The block's working set, after process_block.
+     * @param records_num - Num of packets in the block.
+     * @param stats - Where the time of the stage is counted.
+     *
+     * @return None.
+     */
+    void enqueue_block(packet_block &block,
+                       int records_num,
+                       nic_stats &stats);
+
+    /**
+     * @fn release_block
+     * @brief Destructs the packets of a block and releases their memory.
+     *
+     * @param block - The block's working set, after enqueue_block.
+     * @param records_num - Num of packets in the block.
+     * @param arena - The arena the packets were created in.
+     *
+     * @return None.
+     */
+    static void release_block(packet_block &block,
+                              int records_num,
+                              packet_arena &arena);
+
+    /**
+     * @fn process_packet
+     * @brief Checks and processes a packet as its exact class, see
+     *        process_as.
+     *
+     * @param packet - The packet to process.
+     * @param check - Whether to check the packet before processing it.
+     * @param dst[out] - Where the packet should be written in.
+     *
+     * @return True if the packet passed, false if it was dropped.
+     */
+    bool process_packet(L4 *packet, bool check, memory_dest &dst);
+
+    /**
+     * @fn record_packet
+     * @brief Writes a packet into a flat record as its exact class, with
+     *        calls bound at compile time as in process_as.
+     *
+     * @param packet - The packet.
+     * @param record[out] - The record to fill.
+     *
+     * @return None.
+     */
+    static void record_packet(const L4 *packet, packet_record &record);
+
+    /**
+     * @fn process_as
+     * @brief Checks and processes a packet. Calls are qualified by the
+     *        packet's exact class, so they are bound at compile time
+     *        instead of through the vtable.
+     *
+     * @param packet - The packet, as its exact class.
+     * @param check - Whether to check the packet before processing it.
+     * @param dst[out] - Where the packet should be written in, LOCAL_DRAM if
+     *                   the packet was dropped.
+     *
+     * @return True if the packet passed, false if it was dropped. The
+     *         packet's drop reason tells why.
+     */
+    template <class packet_t>
+    bool process_as(packet_t *packet, bool check, memory_dest &dst);
+
+    /**
+     * @fn invalid_reason
+     * @brief Finds why a packet failed the block's checksum validation,
+     *        by running the checks of its layer on it.
+     *
+     * @param record - The packet.
+     * @param arena - The arena to create the packet in.
+     *
+     * @return The reason the packet is dropped.
+     */
+    drop_reason invalid_reason(const packet_record &record,
+                               packet_arena &arena) const;
+
+    /**
+     * @fn flow_shard
+     * @brief Picks the worker that owns all packets of a ports pair, so
+     *        writes to the same open port stay in order.
+     *
+     * @param port_key - Key of the packet's ports, see L4::port_key.
+     * @param workers_num - Number of workers.
+     *
+     * @return The worker, in [0, workers_num).
+     */
+    static unsigned int flow_shard(unsigned int port_key,
+                                   unsigned int workers_num);
+
+    /**
+     * @fn run_workers
+     * @brief Runs work on workers_num threads (the calling thread is
+     *        worker 0) and waits for all of them. An exception thrown by
+     *        a worker is rethrown once all workers are done.
+     *
+     * @param workers_num - Number of workers.
+     * @param work - Function to run, gets the index of the worker.
+     *
+     * @return None.
+     */
+    static void run_workers(unsigned int workers_num,
+                            const std::function<void(unsigned int)> &work);
+
+    /**
+     * @fn enqueue
+     * @brief Sends a processed packet to its destination queue: to the
+     *        queue's fixed capacity queue or sink if it has one, otherwise
+     *        to RQ/TQ. Only a sink gets the packet as a string.
+     *
+     * @param dst - Destination of the packet.
+     * @param record - The packet, as a record.
+     *
+     * @return None.
+     */
+    void enqueue(memory_dest dst, const packet_record &record);
+
+    /**
+     * @fn print_results
+     * @brief Formats the results of nic_print_results and writes them.
+     *
+     * @param out - The writer to format the results into, flushed at
+     *              the end.
+     *
+     * @return None.
+     */
+    void print_results(fd_writer &out);
+
+    /**
+     * @fn add_stats
+     * @brief Adds the stats a thread of the parallel flows counted to the
+     *        NIC's stats. Safe to call from several threads.
+     *
+     * @param thread_stats - The thread's stats.
+     *
+     * @return None.
+     */
+    void add_stats(const nic_stats &thread_stats);
+
+    /**
+     * @fn flush_sinks
+     * @brief Flushes the sinks of RQ and TQ, if set.
+     *
+     * @return None.
+     */
+    void flush_sinks();
+
     /**
      * @param open_ports - Vector containing all open communications.
-     * @param RQ - Vector of strings to store packets that sent to RQ.
-     * @param TQ - Vector of strings to store packets that sent to TQ.
+     * @param RQ - Vector of records to store packets that sent to RQ.
+     * @param TQ - Vector of records to store packets that sent to TQ.
+     * @param context - NIC's lookups (ports index, local net), bound to
+     *                  every packet the NIC creates.
+     * @param arena - Memory of the packets created by packet_factory.
+     * @param block - Working set of the block the serial flows handle.
+     * @param rq_sink - Where RQ packets are streamed to, not owned.
+     * @param tq_sink - Where TQ packets are streamed to, not owned.
+     * @param rq_queue - Fixed capacity queue of RQ packets, not owned.
+     * @param tq_queue - Fixed capacity queue of TQ packets, not owned.
+     * @param sink_out - Buffer packets for a sink are written in.
+     * @param sink_str - The packet for a sink as a string, reused.
+     * @param stats - Counters and stage times of the NIC, threads of the
+     *                parallel flows count into their own and add them.
+     * @param stats_mutex - Guards adding threads' stats to stats.
+     * @param cache - Records of recently parsed lines, nullptr for none.
      */
     open_port_vec open_ports;
-    std::vector<std::string> RQ;
-    std::vector<std::string> TQ;
+    nic_context context;
+    packet_arena arena;
+    packet_block block;
+    std::vector<packet_record> RQ;
+    std::vector<packet_record> TQ;
+    queue_sink* rq_sink;
+    queue_sink* tq_sink;
+    packet_queue* rq_queue;
+    packet_queue* tq_queue;
+    out_buffer sink_out;
+    std::string sink_str;
+    nic_stats stats;
+    std::mutex stats_mutex;
+    std::unique_ptr<parse_cache> cache;
 
     uint8_t* nic_mac;
     uint8_t* nic_ip;
@@ -104,36 +681,69 @@ class nic_sim {
     * @param ip_mask - the string of ip and mask. format:
                       "ip/mask".
     * @param ip_arr = the array to write the ip into.
-    * @return the mask as an int.
+    * @return the mask as an int, throws std::invalid_argument if there
+              is no mask.
     */
     static uint8_t seperate_ip_mask(std::string ip_mask, uint8_t* ip_arr);
 
+    /**
+    * @fn add_route
+    * @brief Adds a route line of the param file to the NIC's routes.
+    * @param route - The line, format: "route <ip>/<prefix_len> <action>",
+                     action is one of "rq", "tq" or "drop". The ip's bits
+                     past prefix_len must be 0.
+    * @return None, throws std::invalid_argument if the line is invalid.
+    */
+    void add_route(const std::string &route);
+
+    /**
+    * @fn add_mac
+    * @brief Adds a MAC line of the param file to the dst MACs the NIC
+    *        accepts.
+    * @param mac - The line, format: "mac xx:xx:xx:xx:xx:xx".
+    * @return None, throws std::invalid_argument if the line is invalid.
+    */
+    void add_mac(const std::string &mac);
+
+    /**
+    * @fn check_fields_num
+    * @brief Makes sure a tokenized packet has all the fields of its layer.
+    * @param tokenizer - The tokenized packet.
+    * @param fields_num - Number of fields the packet's layer has.
+    * @return None, throws std::invalid_argument if fields are missing.
+    */
+    static void check_fields_num(const packet_tokenizer &tokenizer,
+                                 int fields_num);
+
     /**
     * @fn create_L4
-    * @brief creates an object L4 from string.
-    * @param packet - string representing the packet. format:
+    * @brief creates an object L4 from the tokenized packet.
+    * @param fields - fields of the packet, split by '|'. format:
                       "src_port|dst_port|addrs|L5_data".
+    * @param arena - the arena to create the packet in.
     * @return pointer to L4 packet.
     */
-    L4* create_L4(std::string &packet);
+    L4* create_L4(const str_view fields[], packet_arena &arena) const;
 
     /**
     * @fn create_L3
-    * @brief creates an object L3 from string.
-    * @param packet - string representing the packet. format:
+    * @brief creates an object L3 from the tokenized packet.
+    * @param fields - fields of the packet, split by '|'. format:
                       "src_ip|dst_ip|ttl|cs|L4_packet".
+    * @param arena - the arena to create the packet in.
     * @return pointer to L3 packet.
     */
-    L3* create_L3(std::string &packet);
+    L3* create_L3(const str_view fields[], packet_arena &arena) const;
 
     /**
     * @fn create_L2
-    * @brief creates an object L2 from string.
-    * @param packet - string representing the packet. format:
+    * @brief creates an object L2 from the tokenized packet.
+    * @param fields - fields of the packet, split by '|'. format:
                       "src_mac|dst_mac|L3_packet|cs".
+    * @param arena - the arena to create the packet in.
     * @return pointer to L2 packet.
     */
-    L2* create_L2(std::string &packet);
+    L2* create_L2(const str_view fields[], packet_arena &arena) const;
 
 
     /**
@@ -0,0 +1,534 @@
+#include "NIC_sim.hpp"
+#include "trace_gen.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Min time a benchmark is measured for, runs are doubled until it passes */
+const double BENCH_MIN_SECONDS = 0.5;
+/* Num of packets a micro benchmark goes over in one run */
+const size_t BENCH_MICRO_PACKETS = 4096;
+
+/* Num of routes of the route table benchmark, as of a full routing table */
+const int BENCH_ROUTES_NUM = 131072;
+/* Num of addresses of the MAC filter benchmark, unicast and multicast */
+const int BENCH_MACS_NUM = 4096;
+
+/* Results are folded into this, so measured calls aren't optimized out */
+static volatile unsigned long bench_sink;
+
+/* Runs the micro benchmarks of the packet classes and the end to end
+   benchmarks of nic_sim over a synthetic trace. Friend of the classes it
+   measures, to call their helpers directly. */
+class nic_bench {
+	trace_config config;
+	std::string param_file;
+	std::string packet_file;
+	double min_seconds;
+	std::string filter;
+
+	/* the first BENCH_MICRO_PACKETS packets of the trace */
+	std::vector<std::string> lines;
+	std::vector<packet_record> records;
+
+	public:
+
+		/**
+		* @fn nic_bench
+		* @brief Constructor of the class, generates the trace.
+		* @param config - Shape of the traffic.
+		* @param prefix - Prefix of the trace files' names.
+		* @param min_seconds - Min time each benchmark is measured for.
+		* @param filter - Only benchmarks whose name contains it run.
+		* @return New benchmark object.
+		*/
+		nic_bench(const trace_config &config,
+				  const std::string &prefix,
+				  double min_seconds,
+				  const std::string &filter);
+
+		/**
+		* @fn run_all
+		* @brief Runs all the benchmarks that pass the filter, printing a
+		*		 line per benchmark.
+		* @return None.
+		*/
+		void run_all();
+
+	private:
+
+		/**
+		* @fn run
+		* @brief Calls a benchmark body until it ran for min_seconds, and
+		*		 prints ns per packet and packets per second.
+		* @param name - Name of the benchmark.
+		* @param packets - Num of packets one call of body handles.
+		* @param body - The measured code.
+		* @return None.
+		*/
+		template <class body_t>
+		void run(const char* name, size_t packets, body_t body);
+
+		/**
+		* @fn bench_data_to_arr
+		* @brief Measures decoding the hex payload of a packet.
+		* @return None.
+		*/
+		void bench_data_to_arr();
+
+		/**
+		* @fn bench_in_local_net
+		* @brief Measures the local net check of the IPs of L3 and L2
+		*		 packets.
+		* @return None.
+		*/
+		void bench_in_local_net();
+
+		/**
+		* @fn bench_calc_sum
+		* @brief Measures the checksum of each packet's outermost layer.
+		* @return None.
+		*/
+		void bench_calc_sum();
+
+		/**
+		* @fn bench_route_lookup
+		* @brief Measures longest prefix match lookups of the packets'
+		*		 dst IPs in a table of BENCH_ROUTES_NUM random routes.
+		* @return None.
+		*/
+		void bench_route_lookup();
+
+		/**
+		* @fn bench_mac_lookup
+		* @brief Measures looking up the dst MACs of the L2 packets in a
+		*		 filter of BENCH_MACS_NUM random addresses.
+		* @return None.
+		*/
+		void bench_mac_lookup();
+
+		/**
+		* @fn bench_packet_factory
+		* @brief Measures creating packets out of their lines.
+		* @return None.
+		*/
+		void bench_packet_factory();
+
+		/**
+		* @fn bench_nic_flow
+		* @brief Measures whole runs over the trace file: the single
+		*		 threaded flow, with and without the parse cache, the
+		*		 sharded flow and the pipelined flow.
+		* @return None.
+		*/
+		void bench_nic_flow();
+};
+
+/**
+* @fn nic_bench
+* @brief Constructor of the class, generates the trace.
+* @param config - Shape of the traffic.
+* @param prefix - Prefix of the trace files' names.
+* @param min_seconds - Min time each benchmark is measured for.
+* @param filter - Only benchmarks whose name contains it run.
+* @return New benchmark object.
+*/
+nic_bench::nic_bench(const trace_config &config,
+					 const std::string &prefix,
+					 double min_seconds,
+					 const std::string &filter):
+	config(config),
+	param_file(prefix + "param.txt"),
+	packet_file(prefix + "packets.txt"),
+	min_seconds(min_seconds),
+	filter(filter) {
+
+	trace_gen(config).write_files(this->param_file, this->packet_file);
+
+	packet_reader file(this->packet_file);
+	str_view line;
+	while (this->lines.size() < BENCH_MICRO_PACKETS && file.next_line(line)) {
+		this->lines.emplace_back(line.ptr, line.len);
+
+		packet_record record;
+		nic_sim::line_to_record(line, record);
+		this->records.push_back(record);
+	}
+}
+
+/**
+* @fn run_all
+* @brief Runs all the benchmarks that pass the filter, printing a
+*		 line per benchmark.
+* @return None.
+*/
+void nic_bench::run_all() {
+	printf("%-28s %12s %14s %12s\n",
+		   "benchmark", "ns/packet", "packets/s", "runs");
+
+	this->bench_data_to_arr();
+	this->bench_in_local_net();
+	this->bench_calc_sum();
+	this->bench_route_lookup();
+	this->bench_mac_lookup();
+	this->bench_packet_factory();
+	this->bench_nic_flow();
+}
+
+/**
+* @fn run
+* @brief Calls a benchmark body until it ran for min_seconds, and
+*		 prints ns per packet and packets per second.
+* @param name - Name of the benchmark.
+* @param packets - Num of packets one call of body handles.
+* @param body - The measured code.
+* @return None.
+*/
+template <class body_t>
+void nic_bench::run(const char* name, size_t packets, body_t body) {
+	typedef std::chrono::steady_clock clock;
+
+	if (strstr(name, this->filter.c_str()) == nullptr || packets == 0) {
+		return;
+	}
+
+	/* warm up caches and the branch predictor */
+	body();
+
+	unsigned long runs = 1;
+	double seconds;
+	while (true) {
+		clock::time_point start = clock::now();
+		for (unsigned long i = 0; i < runs; i++) {
+			body();
+		}
+		seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		if (seconds >= this->min_seconds) {
+			break;
+		}
+		runs *= 2;
+	}
+
+	double total = double(runs) * packets;
+	printf("%-28s %12.1f %14.0f %12lu\n",
+		   name, seconds * 1e9 / total, total / seconds, runs);
+	fflush(stdout);
+}
+
+/**
+* @fn bench_data_to_arr
+* @brief Measures decoding the hex payload of a packet.
+* @return None.
+*/
+void nic_bench::bench_data_to_arr() {
+	std::vector<str_view> payloads;
+	for (size_t i = 0; i < this->lines.size(); i++) {
+		packet_tokenizer tokenizer(this->lines[i]);
+
+		/* L2 lines end with the checksum, the payload is the one before */
+		int last = tokenizer.size() - 1;
+		if (this->records[i].layer == LAYER_L2) {
+			last--;
+		}
+		payloads.push_back(tokenizer.get_fields()[last]);
+	}
+
+	this->run("L4::data_to_arr", payloads.size(), [&]() {
+		unsigned char data[DATA_L5_SIZE];
+		unsigned long sum = 0;
+
+		for (const str_view &payload: payloads) {
+			L4::data_to_arr(payload, data);
+			sum += data[0];
+		}
+		bench_sink = sum;
+	});
+}
+
+/**
+* @fn bench_in_local_net
+* @brief Measures the local net check of the IPs of L3 and L2 packets.
+* @return None.
+*/
+void nic_bench::bench_in_local_net() {
+	std::vector<packet_record> ip_records;
+	for (const packet_record &record: this->records) {
+		if (record.layer != LAYER_L4) {
+			ip_records.push_back(record);
+		}
+	}
+
+	uint8_t mask = this->config.mask_len;
+	this->run("L3::in_local_net", ip_records.size(), [&]() {
+		unsigned long local = 0;
+
+		for (packet_record &record: ip_records) {
+			local += L3::in_local_net(record.src_ip.data(),
+									  record.dst_ip.data(),
+									  mask);
+		}
+		bench_sink = local;
+	});
+}
+
+/**
+* @fn bench_calc_sum
+* @brief Measures the checksum of each packet's outermost layer.
+* @return None.
+*/
+void nic_bench::bench_calc_sum() {
+	std::vector<std::unique_ptr<L4>> packets;
+	for (const packet_record &record: this->records) {
+		switch (record.layer) {
+			case LAYER_L2:
+				packets.emplace_back(new L2(record));
+				break;
+
+			case LAYER_L3:
+				packets.emplace_back(new L3(record));
+				break;
+
+			default:
+				packets.emplace_back(new L4(record));
+				break;
+		}
+	}
+
+	this->run("calc_sum", packets.size(), [&]() {
+		unsigned long sum = 0;
+
+		for (const std::unique_ptr<L4> &packet: packets) {
+			switch (packet->get_layer()) {
+				case LAYER_L2:
+					sum += static_cast<L2*>(packet.get())->L2::calc_sum();
+					break;
+
+				case LAYER_L3:
+					sum += static_cast<L3*>(packet.get())->L3::calc_sum();
+					break;
+
+				default:
+					sum += packet->L4::calc_sum();
+					break;
+			}
+		}
+		bench_sink = sum;
+	});
+}
+
+/**
+* @fn bench_route_lookup
+* @brief Measures longest prefix match lookups of the packets' dst IPs
+*		 in a table of BENCH_ROUTES_NUM random routes.
+* @return None.
+*/
+void nic_bench::bench_route_lookup() {
+	if (strstr("route_table::lookup", this->filter.c_str()) == nullptr) {
+		return;
+	}
+
+	/* lengths mostly 16 to 24 bits and a few longer, as in real tables */
+	route_table routes;
+	uint64_t state = this->config.seed | 1;
+	for (int i = 0; i < BENCH_ROUTES_NUM; i++) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		uint32_t bits = state >> 32;
+		uint8_t prefix_len = (bits % 64 == 0 ? 25 + bits % 8 :
+											   16 + bits % 9);
+
+		routes.add(static_cast<uint32_t>(state), prefix_len,
+				   static_cast<route_action>(ROUTE_RQ + bits % 3));
+	}
+	routes.build();
+
+	std::vector<uint32_t> ips;
+	for (const packet_record &record: this->records) {
+		if (record.layer != LAYER_L4) {
+			ips.push_back(ipv4_subnet::ip_to_uint(record.dst_ip.data()));
+		}
+	}
+
+	this->run("route_table::lookup", ips.size(), [&]() {
+		unsigned long sum = 0;
+
+		for (uint32_t ip: ips) {
+			sum += routes.lookup(ip);
+		}
+		bench_sink = sum;
+	});
+}
+
+/**
+* @fn bench_mac_lookup
+* @brief Measures looking up the dst MACs of the L2 packets in a
+*		 filter of BENCH_MACS_NUM random addresses.
+* @return None.
+*/
+void nic_bench::bench_mac_lookup() {
+	if (strstr("mac_filter::accepts", this->filter.c_str()) == nullptr) {
+		return;
+	}
+
+	/* the packets' dst MACs are mostly the NIC's, the rest are random,
+	   so most lookups of other addresses miss as they would */
+	nic_sim nic(this->param_file);
+	mac_filter macs = nic.context.macs;
+	uint64_t state = this->config.seed | 1;
+	for (int i = 0; i < BENCH_MACS_NUM; i++) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		uint64_t key = (state >> 16) & (MAC_BROADCAST_KEY - 1);
+		macs.add(i % 2 == 0 ? key : key | MAC_GROUP_BIT);
+	}
+
+	std::vector<uint64_t> keys;
+	for (const packet_record &record: this->records) {
+		if (record.layer == LAYER_L2) {
+			keys.push_back(mac_filter::to_key(record.dst_mac.data()));
+		}
+	}
+
+	this->run("mac_filter::accepts", keys.size(), [&]() {
+		unsigned long sum = 0;
+
+		for (uint64_t key: keys) {
+			sum += macs.accepts(key);
+		}
+		bench_sink = sum;
+	});
+}
+
+/**
+* @fn bench_packet_factory
+* @brief Measures creating packets out of their lines.
+* @return None.
+*/
+void nic_bench::bench_packet_factory() {
+	nic_sim nic(this->param_file);
+
+	this->run("nic_sim::packet_factory", this->lines.size(), [&]() {
+		for (std::string &line: this->lines) {
+			generic_packet* packet = nic.packet_factory(line);
+			static_cast<L4*>(packet)->~L4();
+		}
+		nic.arena.reset();
+	});
+}
+
+/**
+* @fn bench_nic_flow
+* @brief Measures whole runs over the trace file: the single threaded
+*		 flow, with and without the parse cache, the sharded flow and
+*		 the pipelined flow.
+* @return None.
+*/
+void nic_bench::bench_nic_flow() {
+	unsigned int threads = std::max(std::thread::hardware_concurrency(), 2u);
+
+	this->run("nic_sim::nic_flow", this->config.packets_num, [&]() {
+		nic_sim nic(this->param_file);
+		nic.nic_flow(this->packet_file);
+	});
+
+	this->run("nic_sim::nic_flow/cache", this->config.packets_num, [&]() {
+		nic_sim nic(this->param_file);
+		nic.set_parse_cache();
+		nic.nic_flow(this->packet_file);
+	});
+
+	this->run("nic_sim::nic_flow/threads", this->config.packets_num, [&]() {
+		nic_sim nic(this->param_file);
+		nic.nic_flow(this->packet_file, threads);
+	});
+
+	this->run("nic_sim::nic_flow_pipeline", this->config.packets_num, [&]() {
+		nic_sim nic(this->param_file);
+		nic.nic_flow_pipeline(this->packet_file, threads / 2);
+	});
+}
+
+/**
+* @fn parse_option
+* @brief Matches an argument "--<name>=<value>".
+* @param arg - The argument.
+* @param name - Name of the option.
+* @param value[out] - The value of the option, if matched.
+* @return True if the argument is the option.
+*/
+static bool parse_option(const char* arg, const char* name, double &value) {
+	size_t name_len = strlen(name);
+
+	if (strncmp(arg, "--", 2) != 0 || strncmp(arg + 2, name, name_len) != 0 ||
+		arg[2 + name_len] != '=') {
+		return false;
+	}
+
+	value = atof(arg + 3 + name_len);
+	return true;
+}
+
+/**
+* @fn main
+* @brief Generates a synthetic trace and benchmarks the NIC over it.
+*        usage: bench.exe [--packets=N] [--seed=N] [--l2=R] [--l3=R]
+*               [--ports=N] [--mask=N] [--bad-cs=R] [--repeat=R]
+*               [--min-time=S] [--gen-only=1] [filter]
+*        Trace files are written to bench_param.txt and bench_packets.txt.
+* @return 0 upon success, 1 otherwise.
+*/
+int main(int argc, char* argv[]) {
+	trace_config config;
+	double min_seconds = BENCH_MIN_SECONDS;
+	double gen_only = 0;
+	std::string filter;
+
+	for (int i = 1; i < argc; i++) {
+		double value;
+
+		if (parse_option(argv[i], "packets", value)) {
+			config.packets_num = value;
+		} else if (parse_option(argv[i], "seed", value)) {
+			config.seed = value;
+		} else if (parse_option(argv[i], "l2", value)) {
+			config.l2_ratio = value;
+		} else if (parse_option(argv[i], "l3", value)) {
+			config.l3_ratio = value;
+		} else if (parse_option(argv[i], "ports", value)) {
+			config.ports_num = value;
+		} else if (parse_option(argv[i], "mask", value)) {
+			config.mask_len = value;
+		} else if (parse_option(argv[i], "bad-cs", value)) {
+			config.bad_cs_ratio = value;
+		} else if (parse_option(argv[i], "repeat", value)) {
+			config.repeat_ratio = value;
+		} else if (parse_option(argv[i], "min-time", value)) {
+			min_seconds = value;
+		} else if (parse_option(argv[i], "gen-only", value)) {
+			gen_only = value;
+		} else if (argv[i][0] != '-') {
+			filter = argv[i];
+		} else {
+			std::cerr << "unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+
+	try {
+		nic_bench bench(config, "bench_", min_seconds, filter);
+		if (gen_only == 0) {
+			bench.run_all();
+		}
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
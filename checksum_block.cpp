@@ -0,0 +1,329 @@
+#include "checksum_block.h"
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#define CHECKSUM_SSE2 1
+#include <emmintrin.h>
+#else
+#define CHECKSUM_SSE2 0
+#endif
+
+/* Num of packets in one vector of a property */
+const int CHECKSUM_LANES = 4;
+
+/**
+* @fn bytes_sum
+* @brief Sums the 4 bytes of a word, see L4::sum_bytes.
+* @param word - The word.
+* @return The sum.
+*/
+static inline uint32_t bytes_sum(uint32_t word) {
+	return (word & 0xff) + ((word >> 8) & 0xff) +
+		   ((word >> 16) & 0xff) + (word >> 24);
+}
+
+/**
+* @fn pack_bytes
+* @brief Packs up to 4 bytes into a word, first byte most significant.
+* @param bytes[] - The bytes.
+* @param bytes_num - Num of bytes.
+* @return The word.
+*/
+static inline uint32_t pack_bytes(const uint8_t bytes[], int bytes_num) {
+	uint32_t word = 0;
+	for (int i = 0; i < bytes_num; i++) {
+		word = (word << 8) | bytes[i];
+	}
+
+	return word;
+}
+
+#if CHECKSUM_SSE2
+
+/**
+* @fn bytes_sum
+* @brief Sums the 4 bytes of each word of a vector.
+* @param words - The words.
+* @return Vector of the sums.
+*/
+static inline __m128i bytes_sum(__m128i words) {
+	const __m128i even_bytes = _mm_set1_epi32(0x00ff00ff);
+	const __m128i low_half = _mm_set1_epi32(0x0000ffff);
+
+	/* each 16 bit half holds the sum of its two bytes */
+	__m128i pairs = _mm_add_epi32(_mm_and_si128(words, even_bytes),
+		_mm_and_si128(_mm_srli_epi32(words, 8), even_bytes));
+
+	return _mm_add_epi32(_mm_and_si128(pairs, low_half),
+						 _mm_srli_epi32(pairs, 16));
+}
+
+/**
+* @fn load_lanes
+* @brief Loads the words of CHECKSUM_LANES packets of a property.
+* @param column[] - The property's array.
+* @param first - First packet.
+* @return The words.
+*/
+static inline __m128i load_lanes(const uint32_t column[], int first) {
+	return _mm_load_si128(reinterpret_cast<const __m128i*>(column + first));
+}
+
+#endif
+
+/**
+* @fn checksum_block
+* @brief Constructor of the class, an empty block.
+* @return New block object.
+*/
+checksum_block::checksum_block() {
+	this->packets_num = 0;
+}
+
+/**
+* @fn load
+* @brief Fills the block with packets, replacing the previous ones.
+*		 The payload of each packet is summed while loading.
+* @param records[] - The packets.
+* @param records_num - Num of packets, up to CHECKSUM_BLOCK_SIZE.
+* @return None, throws std::invalid_argument if there are too many.
+*/
+void checksum_block::load(const packet_record records[], int records_num) {
+	if (records_num < 0 || records_num > CHECKSUM_BLOCK_SIZE) {
+		throw std::invalid_argument("Too many packets for a checksum block.");
+	}
+
+	for (int i = 0; i < records_num; i++) {
+		const packet_record &record = records[i];
+
+		this->layer[i] = record.layer;
+		this->src_port[i] = record.src_port;
+		this->dst_port[i] = record.dst_port;
+		this->addr[i] = record.addr;
+		this->data_sum[i] = sum_payload(record.data.data());
+		this->src_ip[i] = pack_bytes(record.src_ip.data(), IP_V4_SIZE);
+		this->dst_ip[i] = pack_bytes(record.dst_ip.data(), IP_V4_SIZE);
+		this->ttl[i] = record.ttl;
+		this->L3_cs[i] = record.L3_cs;
+		this->src_mac_high[i] = pack_bytes(record.src_mac.data(), 4);
+		this->src_mac_low[i] = pack_bytes(record.src_mac.data() + 4,
+										  MAC_SIZE - 4);
+		this->dst_mac_high[i] = pack_bytes(record.dst_mac.data(), 4);
+		this->dst_mac_low[i] = pack_bytes(record.dst_mac.data() + 4,
+										  MAC_SIZE - 4);
+		this->L2_cs[i] = record.L2_cs;
+	}
+
+	this->packets_num = records_num;
+}
+
+/**
+* @fn validate
+* @brief Checks the packets of the block the way validate_packet
+*		 checks their layer: L3 packets by ttl and cs, L2 packets
+*		 by dst MAC and cs. L4 packets have no checksum and always
+*		 pass, their open port is checked when they are processed.
+*		 Packets of unknown layers pass too.
+* @param mac[] - NIC's MAC address, represented via an array.
+*		 It's compared with vectors, only L2 packets of other
+*		 dst MACs are looked up in macs.
+* @param macs - All dst MACs the NIC accepts.
+* @param valid[out] - CHECKSUM_BITMAP_WORDS words, bit i of word
+*		 i / BITMAP_WORD_BITS is set if packet i is valid.
+* @return None.
+*/
+void checksum_block::validate(const uint8_t mac[],
+							  const mac_filter &macs,
+							  uint64_t valid[]) const {
+	for (int word = 0; word < CHECKSUM_BITMAP_WORDS; word++) {
+		valid[word] = 0;
+	}
+
+	int done = 0;
+
+#if CHECKSUM_SSE2
+	const __m128i mac_high = _mm_set1_epi32(pack_bytes(mac, 4));
+	const __m128i mac_low = _mm_set1_epi32(pack_bytes(mac + 4, MAC_SIZE - 4));
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; done + CHECKSUM_LANES <= this->packets_num;
+		 done += CHECKSUM_LANES) {
+		__m128i ttl = load_lanes(this->ttl, done);
+		__m128i L3_cs = load_lanes(this->L3_cs, done);
+		__m128i dst_mac_high = load_lanes(this->dst_mac_high, done);
+		__m128i dst_mac_low = load_lanes(this->dst_mac_low, done);
+
+		__m128i L4_sum = _mm_add_epi32(
+			_mm_add_epi32(bytes_sum(load_lanes(this->src_port, done)),
+						  bytes_sum(load_lanes(this->dst_port, done))),
+			_mm_add_epi32(bytes_sum(load_lanes(this->addr, done)),
+						  load_lanes(this->data_sum, done)));
+
+		__m128i L3_sum = _mm_add_epi32(L4_sum, _mm_add_epi32(
+			_mm_add_epi32(bytes_sum(load_lanes(this->src_ip, done)),
+						  bytes_sum(load_lanes(this->dst_ip, done))),
+			bytes_sum(ttl)));
+
+		__m128i L2_sum = _mm_add_epi32(L3_sum, _mm_add_epi32(
+			_mm_add_epi32(bytes_sum(load_lanes(this->src_mac_high, done)),
+						  bytes_sum(load_lanes(this->src_mac_low, done))),
+			_mm_add_epi32(_mm_add_epi32(bytes_sum(dst_mac_high),
+										bytes_sum(dst_mac_low)),
+						  bytes_sum(L3_cs))));
+
+		__m128i L3_ok = _mm_andnot_si128(_mm_cmpeq_epi32(ttl, zero),
+										 _mm_cmpeq_epi32(L3_cs, L3_sum));
+		__m128i L2_cs_ok = _mm_cmpeq_epi32(load_lanes(this->L2_cs, done),
+										   L2_sum);
+		__m128i mac_ok = _mm_and_si128(_mm_cmpeq_epi32(dst_mac_high,
+													   mac_high),
+									   _mm_cmpeq_epi32(dst_mac_low, mac_low));
+		__m128i L2_ok = _mm_and_si128(L2_cs_ok, mac_ok);
+
+		/* unknown layers pass, creating the packet rejects them */
+		__m128i layer = load_lanes(this->layer, done);
+		__m128i is_L2 = _mm_cmpeq_epi32(layer, _mm_set1_epi32(LAYER_L2));
+		__m128i ok = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi32(layer, _mm_set1_epi32(LAYER_L4)),
+						 _mm_cmpgt_epi32(layer, _mm_set1_epi32(LAYER_L2))),
+			_mm_or_si128(
+				_mm_and_si128(_mm_cmpeq_epi32(layer,
+											  _mm_set1_epi32(LAYER_L3)),
+							  L3_ok),
+				_mm_and_si128(is_L2, L2_ok)));
+
+		uint64_t bits = _mm_movemask_ps(_mm_castsi128_ps(ok));
+
+		/* L2 packets of another dst MAC may still be accepted by the
+		   filter, they are looked up one at a time */
+		int others = _mm_movemask_ps(_mm_castsi128_ps(
+			_mm_andnot_si128(mac_ok, _mm_and_si128(is_L2, L2_cs_ok))));
+		for (int lane = 0; others != 0; lane++, others >>= 1) {
+			if ((others & 1) && macs.accepts(this->dst_mac_key(done + lane))) {
+				bits |= uint64_t(1) << lane;
+			}
+		}
+
+		valid[done / BITMAP_WORD_BITS] |= bits << (done % BITMAP_WORD_BITS);
+	}
+#endif
+
+	this->validate_scalar(mac, macs, done, valid);
+}
+
+/**
+* @fn size
+* @brief Getter to the number of packets in the block.
+* @return The number of packets.
+*/
+int checksum_block::size() const {
+	return this->packets_num;
+}
+
+/**
+* @fn is_valid
+* @brief Reads a packet's bit out of a validity bitmap.
+* @param valid[] - Bitmap filled by validate.
+* @param packet - Index of the packet in the block.
+* @return True if the packet is valid, false otherwise.
+*/
+bool checksum_block::is_valid(const uint64_t valid[], int packet) {
+	return (valid[packet / BITMAP_WORD_BITS] >>
+			(packet % BITMAP_WORD_BITS)) & 1;
+}
+
+/**
+* @fn sum_payload
+* @brief Sums the bytes of a packet's payload.
+* @param data[] - DATA_L5_SIZE bytes of payload.
+* @return The sum.
+*/
+uint32_t checksum_block::sum_payload(const uint8_t data[]) {
+#if CHECKSUM_SSE2
+	static_assert(DATA_L5_SIZE == 32, "payload is summed as two vectors");
+
+	/* psadbw against zero sums each 8 bytes into a 64 bit lane */
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i* src = reinterpret_cast<const __m128i*>(data);
+	__m128i sums = _mm_add_epi64(_mm_sad_epu8(_mm_loadu_si128(src), zero),
+								 _mm_sad_epu8(_mm_loadu_si128(src + 1), zero));
+
+	return _mm_cvtsi128_si32(sums) +
+		   _mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums));
+#else
+	uint32_t sum = 0;
+	for (int i = 0; i < DATA_L5_SIZE; i++) {
+		sum += data[i];
+	}
+
+	return sum;
+#endif
+}
+
+/**
+* @fn dst_mac_key
+* @brief Getter to a packet's dst MAC as a key of a mac_filter.
+* @param packet - Index of the packet in the block.
+* @return The key.
+*/
+uint64_t checksum_block::dst_mac_key(int packet) const {
+	return (uint64_t(this->dst_mac_high[packet]) << 16) |
+		   this->dst_mac_low[packet];
+}
+
+/**
+* @fn validate_scalar
+* @brief Same as validate for packets [first, packets_num), one
+*		 packet at a time.
+* @param mac[] - NIC's MAC address, represented via an array.
+* @param macs - All dst MACs the NIC accepts.
+* @param first - First packet to check.
+* @param valid[out] - Bitmap to set the packets' bits in.
+* @return None.
+*/
+void checksum_block::validate_scalar(const uint8_t mac[],
+									 const mac_filter &macs,
+									 int first,
+									 uint64_t valid[]) const {
+	const uint32_t mac_high = pack_bytes(mac, 4);
+	const uint32_t mac_low = pack_bytes(mac + 4, MAC_SIZE - 4);
+
+	for (int i = first; i < this->packets_num; i++) {
+		uint32_t L4_sum = bytes_sum(this->src_port[i]) +
+						  bytes_sum(this->dst_port[i]) +
+						  bytes_sum(this->addr[i]) + this->data_sum[i];
+		uint32_t L3_sum = L4_sum + bytes_sum(this->src_ip[i]) +
+						  bytes_sum(this->dst_ip[i]) +
+						  bytes_sum(this->ttl[i]);
+		uint32_t L2_sum = L3_sum + bytes_sum(this->src_mac_high[i]) +
+						  bytes_sum(this->src_mac_low[i]) +
+						  bytes_sum(this->dst_mac_high[i]) +
+						  bytes_sum(this->dst_mac_low[i]) +
+						  bytes_sum(this->L3_cs[i]);
+
+		bool ok;
+		switch (this->layer[i]) {
+			case LAYER_L4:
+				ok = true;
+				break;
+
+			case LAYER_L3:
+				ok = this->ttl[i] > 0 && this->L3_cs[i] == L3_sum;
+				break;
+
+			case LAYER_L2:
+				ok = this->L2_cs[i] == L2_sum &&
+					 ((this->dst_mac_high[i] == mac_high &&
+					   this->dst_mac_low[i] == mac_low) ||
+					  macs.accepts(this->dst_mac_key(i)));
+				break;
+
+			default:
+				/* creating the packet rejects it */
+				ok = true;
+				break;
+		}
+
+		valid[i / BITMAP_WORD_BITS] |= uint64_t(ok) << (i % BITMAP_WORD_BITS);
+	}
+}
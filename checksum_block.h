@@ -0,0 +1,127 @@
+#ifndef __CHECKSUM_BLOCK__
+#define __CHECKSUM_BLOCK__
+
+#include <cstdint>
+#include "mac_filter.h"
+#include "packet_record.h"
+
+/* Max num of packets validated together */
+const int CHECKSUM_BLOCK_SIZE = 256;
+/* Num of packets in one word of a validity bitmap */
+const int BITMAP_WORD_BITS = 64;
+/* Num of words in the validity bitmap of a block */
+const int CHECKSUM_BITMAP_WORDS = CHECKSUM_BLOCK_SIZE / BITMAP_WORD_BITS;
+
+/* A block of packets kept as a structure of arrays, one array per
+   property, so the checksums of all of them are computed together with
+   vector instructions instead of one packet at a time */
+class checksum_block {
+	int packets_num;
+
+	alignas(16) uint32_t layer[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t src_port[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t dst_port[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t addr[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t data_sum[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t src_ip[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t dst_ip[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t ttl[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t L3_cs[CHECKSUM_BLOCK_SIZE];
+	/* MAC addresses split to their first 4 and last 2 bytes */
+	alignas(16) uint32_t src_mac_high[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t src_mac_low[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t dst_mac_high[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t dst_mac_low[CHECKSUM_BLOCK_SIZE];
+	alignas(16) uint32_t L2_cs[CHECKSUM_BLOCK_SIZE];
+
+	/* tests compare the vector loop with the scalar one */
+	friend class checksum_block_test;
+
+	public:
+
+		/**
+		* @fn checksum_block
+		* @brief Constructor of the class, an empty block.
+		* @return New block object.
+		*/
+		checksum_block();
+
+		/**
+		* @fn load
+		* @brief Fills the block with packets, replacing the previous ones.
+		*		 The payload of each packet is summed while loading.
+		* @param records[] - The packets.
+		* @param records_num - Num of packets, up to CHECKSUM_BLOCK_SIZE.
+		* @return None, throws std::invalid_argument if there are too many.
+		*/
+		void load(const packet_record records[], int records_num);
+
+		/**
+		* @fn validate
+		* @brief Checks the packets of the block the way validate_packet
+		*		 checks their layer: L3 packets by ttl and cs, L2 packets
+		*		 by dst MAC and cs. L4 packets have no checksum and always
+		*		 pass, their open port is checked when they are processed.
+		*		 Packets of unknown layers pass too.
+		* @param mac[] - NIC's MAC address, represented via an array.
+		*		 It's compared with vectors, only L2 packets of other
+		*		 dst MACs are looked up in macs.
+		* @param macs - All dst MACs the NIC accepts.
+		* @param valid[out] - CHECKSUM_BITMAP_WORDS words, bit i of word
+		*		 i / BITMAP_WORD_BITS is set if packet i is valid.
+		* @return None.
+		*/
+		void validate(const uint8_t mac[],
+					  const mac_filter &macs,
+					  uint64_t valid[]) const;
+
+		/**
+		* @fn size
+		* @brief Getter to the number of packets in the block.
+		* @return The number of packets.
+		*/
+		int size() const;
+
+		/**
+		* @fn is_valid
+		* @brief Reads a packet's bit out of a validity bitmap.
+		* @param valid[] - Bitmap filled by validate.
+		* @param packet - Index of the packet in the block.
+		* @return True if the packet is valid, false otherwise.
+		*/
+		static bool is_valid(const uint64_t valid[], int packet);
+
+	private:
+
+		/**
+		* @fn sum_payload
+		* @brief Sums the bytes of a packet's payload.
+		* @param data[] - DATA_L5_SIZE bytes of payload.
+		* @return The sum.
+		*/
+		static uint32_t sum_payload(const uint8_t data[]);
+
+		/**
+		* @fn dst_mac_key
+		* @brief Getter to a packet's dst MAC as a key of a mac_filter.
+		* @param packet - Index of the packet in the block.
+		* @return The key.
+		*/
+		uint64_t dst_mac_key(int packet) const;
+
+		/**
+		* @fn validate_scalar
+		* @brief Same as validate for packets [first, packets_num), one
+		*		 packet at a time.
+		* @param mac[] - NIC's MAC address, represented via an array.
+		* @param macs - All dst MACs the NIC accepts.
+		* @param first - First packet to check.
+		* @param valid[out] - Bitmap to set the packets' bits in.
+		* @return None.
+		*/
+		void validate_scalar(const uint8_t mac[],
+							 const mac_filter &macs,
+							 int first,
+							 uint64_t valid[]) const;
+};
+#endif
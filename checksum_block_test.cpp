@@ -0,0 +1,266 @@
+#include "checksum_block.h"
+#include "unit_test.h"
+#include <vector>
+
+/* Num of random blocks validated of each size */
+const int TEST_BLOCKS_NUM = 20;
+/* Layer of a packet the block doesn't know */
+const uint8_t TEST_UNKNOWN_LAYER = LAYER_L2 + 1;
+
+/* Tests of checksum_block, friend of it to run the scalar loop over
+   whole blocks and compare it with the vector one */
+class checksum_block_test {
+	uint64_t state;
+	uint8_t nic_mac[MAC_SIZE];
+	uint8_t other_mac[MAC_SIZE];
+	mac_filter macs;
+
+	public:
+
+		/**
+		* @fn checksum_block_test
+		* @brief Constructor of the class. The NIC has its own MAC and
+		*		 accepts one other.
+		* @param seed - Seed of the random packets.
+		* @return New test object.
+		*/
+		checksum_block_test(uint64_t seed): state(seed) {
+			const uint8_t mac[MAC_SIZE] = {0x00, 0x1a, 0x2b, 0x3c, 0x4d, 0x5e};
+			const uint8_t other[MAC_SIZE] = {0x01, 0x00, 0x5e, 0x00, 0x00, 0xfb};
+
+			for (int i = 0; i < MAC_SIZE; i++) {
+				this->nic_mac[i] = mac[i];
+				this->other_mac[i] = other[i];
+			}
+			this->macs.add(mac_filter::to_key(other));
+		}
+
+		/**
+		* @fn run_all
+		* @brief Runs all tests.
+		* @return None.
+		*/
+		void run_all() {
+			this->test_sizes();
+			this->test_known_packets();
+		}
+
+	private:
+
+		/**
+		* @fn next_random
+		* @brief Steps the random state.
+		* @return 32 random bits.
+		*/
+		uint32_t next_random() {
+			this->state = this->state * 6364136223846793005ULL +
+						  1442695040888963407ULL;
+			return this->state >> 32;
+		}
+
+		/**
+		* @fn bytes_sum
+		* @brief Sums the bytes of a field, one at a time.
+		* @param field - The field.
+		* @return The sum.
+		*/
+		static uint32_t bytes_sum(uint32_t field) {
+			uint32_t sum = 0;
+			for (; field != 0; field >>= 8) {
+				sum += field & 0xff;
+			}
+
+			return sum;
+		}
+
+		/**
+		* @fn L3_sum
+		* @brief Sums the bytes a packet's L3 cs covers.
+		* @param record - The packet.
+		* @return The sum.
+		*/
+		static uint32_t L3_sum(const packet_record &record) {
+			uint32_t sum = bytes_sum(record.src_port) +
+						   bytes_sum(record.dst_port) +
+						   bytes_sum(record.addr) + bytes_sum(record.ttl);
+			for (uint8_t byte: record.data) {
+				sum += byte;
+			}
+			for (int i = 0; i < IP_V4_SIZE; i++) {
+				sum += record.src_ip[i] + record.dst_ip[i];
+			}
+
+			return sum;
+		}
+
+		/**
+		* @fn L2_sum
+		* @brief Sums the bytes a packet's L2 cs covers.
+		* @param record - The packet.
+		* @return The sum.
+		*/
+		static uint32_t L2_sum(const packet_record &record) {
+			uint32_t sum = L3_sum(record) + bytes_sum(record.L3_cs);
+			for (int i = 0; i < MAC_SIZE; i++) {
+				sum += record.src_mac[i] + record.dst_mac[i];
+			}
+
+			return sum;
+		}
+
+		/**
+		* @fn random_record
+		* @brief Makes a random packet of any layer, about half of them
+		*		 valid.
+		* @param record[out] - The packet.
+		* @return Whether the packet should pass validate.
+		*/
+		bool random_record(packet_record &record) {
+			record = packet_record();
+			record.layer = this->next_random() % (TEST_UNKNOWN_LAYER + 1);
+			record.src_port = this->next_random();
+			record.dst_port = this->next_random();
+			record.addr = this->next_random() % DATA_ARR_SIZE;
+			for (uint8_t &byte: record.data) {
+				byte = this->next_random();
+			}
+
+			if (record.layer == LAYER_L4 ||
+				record.layer == TEST_UNKNOWN_LAYER) {
+				return true;
+			}
+
+			for (int i = 0; i < IP_V4_SIZE; i++) {
+				record.src_ip[i] = this->next_random();
+				record.dst_ip[i] = this->next_random();
+			}
+			/* a ttl of 0 fails even with the right cs */
+			record.ttl = this->next_random() % 5 == 0 ?
+						 0 : this->next_random() % 256;
+			record.L3_cs = L3_sum(record) + this->next_random() % 2;
+			bool L3_ok = record.ttl > 0 && record.L3_cs == L3_sum(record);
+
+			if (record.layer == LAYER_L3) {
+				return L3_ok;
+			}
+
+			uint32_t mac_kind = this->next_random() % 3;
+			for (int i = 0; i < MAC_SIZE; i++) {
+				record.src_mac[i] = this->next_random();
+				record.dst_mac[i] = mac_kind == 0 ? this->nic_mac[i] :
+									mac_kind == 1 ? this->other_mac[i] :
+									this->next_random();
+			}
+			record.L2_cs = L2_sum(record) + this->next_random() % 2;
+
+			/* a random dst MAC is never accepted, up to a 2^-48 chance */
+			return record.L2_cs == L2_sum(record) && mac_kind != 2;
+		}
+
+		/**
+		* @fn validate_both
+		* @brief Validates a block with validate and with the scalar loop
+		*		 alone, and checks both against the expected bits.
+		* @param records - The packets.
+		* @param expected - Whether each packet should pass.
+		* @return None.
+		*/
+		void validate_both(const std::vector<packet_record> &records,
+						   const std::vector<bool> &expected) {
+			checksum_block block;
+			block.load(records.data(), records.size());
+			CHECK(block.size() == int(records.size()));
+
+			uint64_t valid[CHECKSUM_BITMAP_WORDS];
+			block.validate(this->nic_mac, this->macs, valid);
+
+			uint64_t scalar_valid[CHECKSUM_BITMAP_WORDS] = {};
+			block.validate_scalar(this->nic_mac, this->macs, 0, scalar_valid);
+
+			for (int word = 0; word < CHECKSUM_BITMAP_WORDS; word++) {
+				CHECK(valid[word] == scalar_valid[word]);
+			}
+
+			for (int i = 0; i < CHECKSUM_BLOCK_SIZE; i++) {
+				bool expected_bit = i < int(records.size()) && expected[i];
+				CHECK(checksum_block::is_valid(valid, i) == expected_bit);
+			}
+		}
+
+		/**
+		* @fn test_sizes
+		* @brief Validates random blocks of sizes around the vector width
+		*		 and the bitmap words, so packets past the last full
+		*		 vector are left to the scalar loop.
+		* @return None.
+		*/
+		void test_sizes() {
+			const int sizes[] = {1, 3, 4, 5, 7, 63, 64, 65, 130,
+								 CHECKSUM_BLOCK_SIZE - 1, CHECKSUM_BLOCK_SIZE};
+
+			for (int size: sizes) {
+				for (int i = 0; i < TEST_BLOCKS_NUM; i++) {
+					std::vector<packet_record> records(size);
+					std::vector<bool> expected(size);
+
+					for (int packet = 0; packet < size; packet++) {
+						expected[packet] = this->random_record(records[packet]);
+					}
+
+					this->validate_both(records, expected);
+				}
+			}
+		}
+
+		/**
+		* @fn test_known_packets
+		* @brief Validates a block of one packet of each case, 6 of them so
+		*		 the last two are past the first vector.
+		* @return None.
+		*/
+		void test_known_packets() {
+			std::vector<packet_record> records(6);
+			for (packet_record &record: records) {
+				record.layer = LAYER_L2;
+				record.ttl = 64;
+				record.src_ip = {{10, 0, 0, 1}};
+				record.dst_ip = {{10, 0, 0, 2}};
+				record.L3_cs = L3_sum(record);
+				for (int i = 0; i < MAC_SIZE; i++) {
+					record.dst_mac[i] = this->nic_mac[i];
+				}
+			}
+
+			/* 0: own MAC, 1: MAC of the filter, 2: broadcast, which the
+			   filter doesn't accept, 3: bad L2 cs, 4: L3 of ttl 0,
+			   5: L3 of the right cs */
+			for (int i = 0; i < MAC_SIZE; i++) {
+				records[1].dst_mac[i] = this->other_mac[i];
+				records[2].dst_mac[i] = 0xff;
+			}
+			records[4].layer = LAYER_L3;
+			records[4].ttl = 0;
+			records[4].L3_cs = L3_sum(records[4]);
+			records[5].layer = LAYER_L3;
+
+			for (packet_record &record: records) {
+				record.L2_cs = record.layer == LAYER_L2 ? L2_sum(record) : 0;
+			}
+			records[3].L2_cs++;
+
+			this->validate_both(records, {true, true, false, false, false,
+										  true});
+		}
+};
+
+/**
+* @fn main
+* @brief Runs the tests of checksum_block.
+* @return 0 if they passed, 1 otherwise.
+*/
+int main() {
+	checksum_block_test test(1);
+	test.run_all();
+
+	return unit_test_result("checksum_block");
+}
@@ -0,0 +1,117 @@
+#include "fd_writer.h"
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* Permissions of a file the writer creates, before the umask */
+static const mode_t NEW_FILE_MODE = 0644;
+
+/**
+* @fn fd_writer
+* @brief Constructor of the class, writes to an open descriptor.
+* @param fd - The descriptor, not closed by the writer.
+* @return New writer object.
+*/
+fd_writer::fd_writer(int fd): fd(fd), own_fd(false), current(0) {
+	for (int i = 0; i < WRITER_BUFFERS_NUM; i++) {
+		this->buffers.emplace_back(WRITER_BUFFER_SIZE);
+	}
+}
+
+/**
+* @fn fd_writer
+* @brief Constructor of the class, creates or truncates a file.
+* @param file_name - Name of the file to write to.
+* @return New writer object, throws std::invalid_argument if the
+*		  file can't be opened.
+*/
+fd_writer::fd_writer(const std::string &file_name): fd_writer(-1) {
+	this->fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+					NEW_FILE_MODE);
+	if (this->fd < 0) {
+		throw std::invalid_argument("Could not open the file.");
+	}
+
+	this->own_fd = true;
+}
+
+/**
+* @fn buffer
+* @brief Getter to the buffer output should be appended to. Moves
+*		 to the next buffer when the current one is full, writing
+*		 all of them first if none is left.
+* @return The buffer, valid until the next call.
+*/
+out_buffer& fd_writer::buffer() {
+	if (this->buffers[this->current].size() >= WRITER_BUFFER_SIZE) {
+		if (this->current == WRITER_BUFFERS_NUM - 1) {
+			this->flush();
+		} else {
+			this->current++;
+		}
+	}
+
+	return this->buffers[this->current];
+}
+
+/**
+* @fn flush
+* @brief Writes all buffered output and empties the buffers.
+* @return None, throws std::invalid_argument if writing failed.
+*/
+void fd_writer::flush() {
+	struct iovec iov[WRITER_BUFFERS_NUM];
+	int iov_num = 0;
+
+	for (int i = 0; i <= this->current; i++) {
+		if (this->buffers[i].size() > 0) {
+			iov[iov_num].iov_base = const_cast<char*>(this->buffers[i].data());
+			iov[iov_num].iov_len = this->buffers[i].size();
+			iov_num++;
+		}
+	}
+
+	/* writev may write only part of the buffers, the rest is retried */
+	struct iovec* next = iov;
+	while (iov_num > 0) {
+		ssize_t written = writev(this->fd, next, iov_num);
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			throw std::invalid_argument("Could not write the output.");
+		}
+
+		while (iov_num > 0 && static_cast<size_t>(written) >= next->iov_len) {
+			written -= next->iov_len;
+			next++;
+			iov_num--;
+		}
+
+		if (iov_num > 0) {
+			next->iov_base = static_cast<char*>(next->iov_base) + written;
+			next->iov_len -= written;
+		}
+	}
+
+	for (int i = 0; i <= this->current; i++) {
+		this->buffers[i].clear();
+	}
+	this->current = 0;
+}
+
+/**
+* @fn ~fd_writer
+* @brief Closes the file if the writer opened it. Output that
+*		 wasn't flushed is lost.
+* @return None.
+*/
+fd_writer::~fd_writer() {
+	if (this->own_fd) {
+		close(this->fd);
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef __FD_WRITER__
+#define __FD_WRITER__
+
+#include <string>
+#include <vector>
+#include "out_buffer.h"
+
+/* Num of chars an fd_writer formats into a buffer before taking the next */
+const size_t WRITER_BUFFER_SIZE = 1 << 20;
+/* Num of buffers an fd_writer fills before writing them in one writev */
+const int WRITER_BUFFERS_NUM = 8;
+
+/* Writes large output to a file descriptor without per line calls: output
+   is formatted into a few big buffers, and once they are all full they are
+   written together with a single writev. Nothing is written until a
+   buffer fills or flush is called. */
+class fd_writer {
+	int fd;
+	bool own_fd;
+	std::vector<out_buffer> buffers;
+	int current;
+
+	public:
+
+		/**
+		* @fn fd_writer
+		* @brief Constructor of the class, writes to an open descriptor.
+		* @param fd - The descriptor, not closed by the writer.
+		* @return New writer object.
+		*/
+		fd_writer(int fd);
+
+		/**
+		* @fn fd_writer
+		* @brief Constructor of the class, creates or truncates a file.
+		* @param file_name - Name of the file to write to.
+		* @return New writer object, throws std::invalid_argument if the
+		*		  file can't be opened.
+		*/
+		fd_writer(const std::string &file_name);
+
+		fd_writer(const fd_writer &other) = delete;
+		fd_writer& operator=(const fd_writer &other) = delete;
+
+		/**
+		* @fn buffer
+		* @brief Getter to the buffer output should be appended to. Moves
+		*		 to the next buffer when the current one is full, writing
+		*		 all of them first if none is left.
+		* @return The buffer, valid until the next call.
+		*/
+		out_buffer& buffer();
+
+		/**
+		* @fn flush
+		* @brief Writes all buffered output and empties the buffers.
+		* @return None, throws std::invalid_argument if writing failed.
+		*/
+		void flush();
+
+		/**
+		* @fn ~fd_writer
+		* @brief Closes the file if the writer opened it. Output that
+		*		 wasn't flushed is lost.
+		* @return None.
+		*/
+		~fd_writer();
+};
+#endif
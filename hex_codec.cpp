@@ -0,0 +1,369 @@
+#include "hex_codec.h"
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEX_CODEC_SSSE3 1
+#include <tmmintrin.h>
+#else
+#define HEX_CODEC_SSSE3 0
+#endif
+
+/* Value of a hex digit char, HEX_INVALID if it isn't one */
+const uint8_t HEX_INVALID = 0xff;
+/* Shuffle index that zeroes the lane */
+const uint8_t HEX_ZERO_LANE = 0x80;
+/* Digits of base 16 */
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+/* Value of every char as a hex digit, HEX_INVALID if it isn't one */
+struct hex_digit_values {
+	uint8_t value[256];
+
+	hex_digit_values() {
+		for (int c = 0; c < 256; c++) {
+			this->value[c] = HEX_INVALID;
+		}
+		for (int d = 0; d < 16; d++) {
+			this->value[static_cast<uint8_t>(HEX_DIGITS[d])] = d;
+			if (d >= 10) {
+				this->value[static_cast<uint8_t>(HEX_DIGITS[d] - 'a' + 'A')] = d;
+			}
+		}
+	}
+};
+
+static const hex_digit_values hex_values;
+
+#if HEX_CODEC_SSSE3
+
+/* Shuffle controls that move HEX_VECTOR_BYTES hex dump entries, read as
+   three vectors, apart into high and low digits - and back */
+struct hex_shuffles {
+	/* [offset][vector][lane] of the high and low digit of each byte, for
+	   a dump read from its first char (offset 0) or the char before */
+	uint8_t high[2][HEX_CHARS_PER_BYTE][HEX_VECTOR_BYTES];
+	uint8_t low[2][HEX_CHARS_PER_BYTE][HEX_VECTOR_BYTES];
+	/* [vector][lane] of the byte whose high / low digit is in each char
+	   of the encoded dump, and the spaces between them */
+	uint8_t to_high[HEX_CHARS_PER_BYTE][HEX_VECTOR_BYTES];
+	uint8_t to_low[HEX_CHARS_PER_BYTE][HEX_VECTOR_BYTES];
+	uint8_t spaces[HEX_CHARS_PER_BYTE][HEX_VECTOR_BYTES];
+
+	hex_shuffles() {
+		for (int offset = 0; offset < 2; offset++) {
+			for (int vec = 0; vec < HEX_CHARS_PER_BYTE; vec++) {
+				for (int i = 0; i < HEX_VECTOR_BYTES; i++) {
+					int high_pos = HEX_CHARS_PER_BYTE * i + offset -
+								   vec * HEX_VECTOR_BYTES;
+					int low_pos = high_pos + 1;
+
+					this->high[offset][vec][i] = lane(high_pos);
+					this->low[offset][vec][i] = lane(low_pos);
+				}
+			}
+		}
+
+		for (int vec = 0; vec < HEX_CHARS_PER_BYTE; vec++) {
+			for (int i = 0; i < HEX_VECTOR_BYTES; i++) {
+				int pos = vec * HEX_VECTOR_BYTES + i;
+				uint8_t byte = pos / HEX_CHARS_PER_BYTE;
+				int digit = pos % HEX_CHARS_PER_BYTE;
+
+				this->to_high[vec][i] = (digit == 0 ? byte : HEX_ZERO_LANE);
+				this->to_low[vec][i] = (digit == 1 ? byte : HEX_ZERO_LANE);
+				this->spaces[vec][i] = (digit == 2 ? ' ' : 0);
+			}
+		}
+	}
+
+	static uint8_t lane(int pos) {
+		return (pos >= 0 && pos < HEX_VECTOR_BYTES ? pos : HEX_ZERO_LANE);
+	}
+};
+
+static const hex_shuffles shuffles;
+
+/**
+* @fn load
+* @brief Loads a vector from an unaligned table.
+* @param table[] - HEX_VECTOR_BYTES entries.
+* @return The vector.
+*/
+__attribute__((target("ssse3")))
+static inline __m128i load(const uint8_t table[]) {
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+}
+
+/**
+* @fn gather_digits
+* @brief Picks one digit of every byte out of three vectors of a dump.
+* @param chars[] - HEX_CHARS_PER_BYTE vectors of the dump.
+* @param shuffle - [vector][lane] shuffle controls of the digit.
+* @return Vector of the digit chars, one per byte.
+*/
+__attribute__((target("ssse3")))
+static inline __m128i gather_digits(const __m128i chars[],
+							const uint8_t shuffle[][HEX_VECTOR_BYTES]) {
+	__m128i digits = _mm_shuffle_epi8(chars[0], load(shuffle[0]));
+	digits = _mm_or_si128(digits, _mm_shuffle_epi8(chars[1], load(shuffle[1])));
+	digits = _mm_or_si128(digits, _mm_shuffle_epi8(chars[2], load(shuffle[2])));
+
+	return digits;
+}
+
+/**
+* @fn digits_to_values
+* @brief Converts hex digit chars to their values, and marks the chars
+*		 that aren't hex digits.
+* @param chars - The digit chars.
+* @param invalid[out] - ORed with a vector, non zero in invalid lanes.
+* @return The values of the digits.
+*/
+__attribute__((target("ssse3")))
+static inline __m128i digits_to_values(__m128i chars, __m128i &invalid) {
+	__m128i dec = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+	__m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+								 _mm_set1_epi8('a'));
+
+	/* unsigned x <= max iff min(x, max) == x */
+	__m128i is_dec = _mm_cmpeq_epi8(_mm_min_epu8(dec, _mm_set1_epi8(9)), dec);
+	__m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)),
+									  alpha);
+
+	invalid = _mm_or_si128(invalid,
+						   _mm_andnot_si128(_mm_or_si128(is_dec, is_alpha),
+											_mm_set1_epi8(-1)));
+
+	__m128i alpha_val = _mm_add_epi8(alpha, _mm_set1_epi8(10));
+
+	return _mm_or_si128(_mm_and_si128(is_dec, dec),
+						_mm_and_si128(is_alpha, alpha_val));
+}
+
+/**
+* @fn decode_vector
+* @brief Decodes HEX_VECTOR_BYTES bytes of a dump.
+* @param hex[] - HEX_CHARS_PER_BYTE * HEX_VECTOR_BYTES readable chars,
+*		 starting offset chars before the first digit.
+* @param offset - 0 or 1, see hex_shuffles.
+* @param bytes[out] - Array of HEX_VECTOR_BYTES bytes to write into.
+* @return True upon success, false if a digit isn't hex.
+*/
+__attribute__((target("ssse3")))
+static bool decode_vector(const char hex[], int offset, unsigned char bytes[]) {
+	const __m128i* src = reinterpret_cast<const __m128i*>(hex);
+	__m128i chars[HEX_CHARS_PER_BYTE];
+	for (int vec = 0; vec < HEX_CHARS_PER_BYTE; vec++) {
+		chars[vec] = _mm_loadu_si128(src + vec);
+	}
+
+	__m128i invalid = _mm_setzero_si128();
+	__m128i high = digits_to_values(gather_digits(chars,
+												  shuffles.high[offset]),
+									invalid);
+	__m128i low = digits_to_values(gather_digits(chars,
+												 shuffles.low[offset]),
+								   invalid);
+
+	/* high values are below 16, shifting them never crosses a byte */
+	__m128i values = _mm_or_si128(_mm_slli_epi16(high, 4), low);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), values);
+
+	return _mm_movemask_epi8(invalid) == 0;
+}
+
+/**
+* @fn encode_vector
+* @brief Encodes HEX_VECTOR_BYTES bytes, each followed by a space.
+* @param bytes[] - HEX_VECTOR_BYTES bytes to convert.
+* @param hex[out] - Buffer of HEX_CHARS_PER_BYTE * HEX_VECTOR_BYTES chars.
+* @return None.
+*/
+__attribute__((target("ssse3")))
+static void encode_vector(const unsigned char bytes[], char hex[]) {
+	const __m128i digits = _mm_loadu_si128(
+		reinterpret_cast<const __m128i*>(HEX_DIGITS));
+	const __m128i nibble = _mm_set1_epi8(0x0f);
+
+	__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+	__m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(
+		_mm_srli_epi16(values, 4), nibble));
+	__m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(values, nibble));
+
+	__m128i* dst = reinterpret_cast<__m128i*>(hex);
+	for (int vec = 0; vec < HEX_CHARS_PER_BYTE; vec++) {
+		__m128i chars = _mm_shuffle_epi8(high, load(shuffles.to_high[vec]));
+		chars = _mm_or_si128(chars, _mm_shuffle_epi8(
+			low, load(shuffles.to_low[vec])));
+		chars = _mm_or_si128(chars, load(shuffles.spaces[vec]));
+
+		_mm_storeu_si128(dst + vec, chars);
+	}
+}
+
+#endif
+
+/**
+* @fn decode
+* @brief Converts a hex dump into bytes, checking every digit.
+*		 Digits missing at the end of a short dump are taken as 0.
+* @param hex - The hex dump, "xx xx ... xx".
+* @param bytes[out] - Array of bytes_num bytes to write into.
+* @param bytes_num - Num of bytes in the dump.
+* @return True upon success, false if a digit isn't hex.
+*/
+bool hex_codec::decode(str_view hex, unsigned char bytes[], int bytes_num) {
+	int done = 0;
+
+#if HEX_CODEC_SSSE3
+	if (has_simd()) {
+		const size_t vector_chars = HEX_CHARS_PER_BYTE * HEX_VECTOR_BYTES;
+		bool valid = true;
+
+		for (; done + HEX_VECTOR_BYTES <= bytes_num;
+			 done += HEX_VECTOR_BYTES) {
+			size_t start = HEX_CHARS_PER_BYTE * done;
+
+			/* the dump has no space after its last byte, so the last
+			   vector may have to be read from one char earlier */
+			if (start + vector_chars <= hex.len) {
+				valid &= decode_vector(hex.ptr + start, 0, bytes + done);
+			} else if (start > 0 && start + vector_chars - 1 <= hex.len) {
+				valid &= decode_vector(hex.ptr + start - 1, 1, bytes + done);
+			} else {
+				break;
+			}
+		}
+
+		if (!valid) {
+			return false;
+		}
+	}
+#endif
+
+	size_t start = HEX_CHARS_PER_BYTE * done;
+	str_view rest(hex.ptr + start, (start < hex.len ? hex.len - start : 0));
+
+	return decode_scalar(rest, bytes + done, bytes_num - done);
+}
+
+/**
+* @fn encode
+* @brief Converts bytes into a hex dump with lower case digits.
+* @param bytes[] - The bytes to convert.
+* @param bytes_num - Num of bytes.
+* @param hex[out] - The hex dump, "xx xx ... xx".
+* @return None.
+*/
+void hex_codec::encode(const unsigned char bytes[],
+					   int bytes_num,
+					   std::string &hex) {
+	if (bytes_num <= 0) {
+		hex.clear();
+		return;
+	}
+
+	hex.resize(HEX_CHARS_PER_BYTE * bytes_num);
+	hex.resize(encode(bytes, bytes_num, &hex[0]));
+}
+
+/**
+* @fn encode
+* @brief Same as encode, into a caller's buffer.
+* @param bytes[] - The bytes to convert.
+* @param bytes_num - Num of bytes.
+* @param hex[out] - Buffer of HEX_CHARS_PER_BYTE * bytes_num chars,
+*		 the last one is overwritten with a space.
+* @return Num of chars of the dump, without the last space.
+*/
+int hex_codec::encode(const unsigned char bytes[],
+					  int bytes_num,
+					  char hex[]) {
+	if (bytes_num <= 0) {
+		return 0;
+	}
+
+	int done = 0;
+
+#if HEX_CODEC_SSSE3
+	if (has_simd()) {
+		for (; done + HEX_VECTOR_BYTES <= bytes_num;
+			 done += HEX_VECTOR_BYTES) {
+			encode_vector(bytes + done, hex + HEX_CHARS_PER_BYTE * done);
+		}
+	}
+#endif
+
+	encode_scalar(bytes + done,
+				  bytes_num - done,
+				  hex + HEX_CHARS_PER_BYTE * done);
+
+	/* no space after the last byte */
+	return HEX_CHARS_PER_BYTE * bytes_num - 1;
+}
+
+/**
+* @fn has_simd
+* @brief Checks once whether the CPU runs the vector kernels.
+* @return True if the vector kernels are used, false otherwise.
+*/
+bool hex_codec::has_simd() {
+#if HEX_CODEC_SSSE3
+	static const bool ssse3 = (__builtin_cpu_init(),
+							   __builtin_cpu_supports("ssse3") != 0);
+	return ssse3;
+#else
+	return false;
+#endif
+}
+
+/**
+* @fn decode_scalar
+* @brief Same as decode, one digit at a time.
+* @param hex - The hex dump.
+* @param bytes[out] - Array of bytes_num bytes to write into.
+* @param bytes_num - Num of bytes in the dump.
+* @return True upon success, false if a digit isn't hex.
+*/
+bool hex_codec::decode_scalar(str_view hex,
+							  unsigned char bytes[],
+							  int bytes_num) {
+	uint8_t invalid = 0;
+
+	for (int i = 0; i < bytes_num; i++) {
+		size_t chunk = HEX_CHARS_PER_BYTE * i;
+		unsigned char value = 0;
+
+		for (size_t dig = chunk; dig < chunk + 2; dig++) {
+			value <<= 4;
+			if (dig < hex.len) {
+				uint8_t digit = hex_values.value[static_cast<uint8_t>(hex.ptr[dig])];
+				invalid |= (digit == HEX_INVALID);
+				value |= (digit & 0x0f);
+			}
+		}
+
+		bytes[i] = value;
+	}
+
+	return invalid == 0;
+}
+
+/**
+* @fn encode_scalar
+* @brief Same as encode, one byte at a time. Writes a space after
+*		 every byte, including the last.
+* @param bytes[] - The bytes to convert.
+* @param bytes_num - Num of bytes.
+* @param hex[out] - Buffer of HEX_CHARS_PER_BYTE * bytes_num chars.
+* @return None.
+*/
+void hex_codec::encode_scalar(const unsigned char bytes[],
+							  int bytes_num,
+							  char hex[]) {
+	for (int i = 0; i < bytes_num; i++) {
+		hex[HEX_CHARS_PER_BYTE * i] = HEX_DIGITS[bytes[i] >> 4];
+		hex[HEX_CHARS_PER_BYTE * i + 1] = HEX_DIGITS[bytes[i] & 0x0f];
+		hex[HEX_CHARS_PER_BYTE * i + 2] = ' ';
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef __HEX_CODEC__
+#define __HEX_CODEC__
+
+#include <string>
+#include "tokenizer.h"
+
+/* Num of chars a byte takes in a hex dump: two digits and a space */
+const int HEX_CHARS_PER_BYTE = 3;
+/* Num of bytes the vector kernels convert at once */
+const int HEX_VECTOR_BYTES = 16;
+
+/* Converts byte arrays to and from space separated hex dumps
+   ("0a 1b ... ff"). Uses SSSE3 kernels when the CPU has them, and falls
+   back to a table driven scalar loop otherwise. */
+class hex_codec {
+	friend class hex_codec_test;
+
+	public:
+
+		/**
+		* @fn decode
+		* @brief Converts a hex dump into bytes, checking every digit.
+		*		 Digits missing at the end of a short dump are taken as 0.
+		* @param hex - The hex dump, "xx xx ... xx".
+		* @param bytes[out] - Array of bytes_num bytes to write into.
+		* @param bytes_num - Num of bytes in the dump.
+		* @return True upon success, false if a digit isn't hex.
+		*/
+		static bool decode(str_view hex, unsigned char bytes[], int bytes_num);
+
+		/**
+		* @fn encode
+		* @brief Converts bytes into a hex dump with lower case digits.
+		* @param bytes[] - The bytes to convert.
+		* @param bytes_num - Num of bytes.
+		* @param hex[out] - The hex dump, "xx xx ... xx".
+		* @return None.
+		*/
+		static void encode(const unsigned char bytes[],
+						   int bytes_num,
+						   std::string &hex);
+
+		/**
+		* @fn encode
+		* @brief Same as encode, into a caller's buffer.
+		* @param bytes[] - The bytes to convert.
+		* @param bytes_num - Num of bytes.
+		* @param hex[out] - Buffer of HEX_CHARS_PER_BYTE * bytes_num chars,
+		*		 the last one is overwritten with a space.
+		* @return Num of chars of the dump, without the last space.
+		*/
+		static int encode(const unsigned char bytes[],
+						  int bytes_num,
+						  char hex[]);
+
+		/**
+		* @fn has_simd
+		* @brief Checks once whether the CPU runs the vector kernels.
+		* @return True if the vector kernels are used, false otherwise.
+		*/
+		static bool has_simd();
+
+	private:
+
+		/**
+		* @fn decode_scalar
+		* @brief Same as decode, one digit at a time.
+		* @param hex - The hex dump.
+		* @param bytes[out] - Array of bytes_num bytes to write into.
+		* @param bytes_num - Num of bytes in the dump.
+		* @return True upon success, false if a digit isn't hex.
+		*/
+		static bool decode_scalar(str_view hex,
+								  unsigned char bytes[],
+								  int bytes_num);
+
+		/**
+		* @fn encode_scalar
+		* @brief Same as encode, one byte at a time. Writes a space after
+		*		 every byte, including the last.
+		* @param bytes[] - The bytes to convert.
+		* @param bytes_num - Num of bytes.
+		* @param hex[out] - Buffer of HEX_CHARS_PER_BYTE * bytes_num chars.
+		* @return None.
+		*/
+		static void encode_scalar(const unsigned char bytes[],
+								  int bytes_num,
+								  char hex[]);
+};
+#endif
@@ -0,0 +1,200 @@
+#include "hex_codec.h"
+#include "unit_test.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Max num of bytes of the dumps the tests convert */
+const int TEST_MAX_BYTES = 80;
+
+/* Tests of hex_codec, friend of it to run the scalar loops on CPUs
+   where decode and encode take the vector kernels */
+class hex_codec_test {
+	uint64_t state;
+
+	public:
+
+		/**
+		* @fn hex_codec_test
+		* @brief Constructor of the class.
+		* @param seed - Seed of the random bytes.
+		* @return New test object.
+		*/
+		hex_codec_test(uint64_t seed): state(seed) {}
+
+		/**
+		* @fn run_all
+		* @brief Runs all tests.
+		* @return None.
+		*/
+		void run_all() {
+			this->test_round_trip();
+			this->test_vector_matches_scalar();
+			this->test_invalid_digits();
+			this->test_upper_case();
+			this->test_short_dump();
+		}
+
+	private:
+
+		/**
+		* @fn random_bytes
+		* @brief Fills bytes with random values.
+		* @param bytes[out] - The bytes.
+		* @param bytes_num - Num of bytes.
+		* @return None.
+		*/
+		void random_bytes(unsigned char bytes[], int bytes_num) {
+			for (int i = 0; i < bytes_num; i++) {
+				this->state = this->state * 6364136223846793005ULL +
+							  1442695040888963407ULL;
+				bytes[i] = this->state >> 56;
+			}
+		}
+
+		/**
+		* @fn test_round_trip
+		* @brief Encodes and decodes dumps of all lengths up to
+		*		 TEST_MAX_BYTES, on the chosen path and the scalar one.
+		* @return None.
+		*/
+		void test_round_trip() {
+			for (int n = 1; n <= TEST_MAX_BYTES; n++) {
+				std::vector<unsigned char> bytes(n);
+				this->random_bytes(bytes.data(), n);
+
+				std::string hex;
+				hex_codec::encode(bytes.data(), n, hex);
+				CHECK(hex.size() == size_t(HEX_CHARS_PER_BYTE * n - 1));
+
+				/* the scalar loop leaves a space after the last byte */
+				std::vector<char> scalar_hex(HEX_CHARS_PER_BYTE * n);
+				hex_codec::encode_scalar(bytes.data(), n, scalar_hex.data());
+				CHECK(hex == std::string(scalar_hex.data(), hex.size()));
+
+				std::vector<unsigned char> decoded(n);
+				CHECK(hex_codec::decode(hex, decoded.data(), n));
+				CHECK(decoded == bytes);
+
+				std::vector<unsigned char> scalar_decoded(n);
+				CHECK(hex_codec::decode_scalar(hex, scalar_decoded.data(), n));
+				CHECK(scalar_decoded == bytes);
+			}
+		}
+
+		/**
+		* @fn test_vector_matches_scalar
+		* @brief Decodes dumps long enough for the vector kernel, with and
+		*		 without a space after the last byte. Without it, the last
+		*		 vector of a dump of 32 bytes or more is read from one char
+		*		 before its first digit.
+		* @return None.
+		*/
+		void test_vector_matches_scalar() {
+			if (!hex_codec::has_simd()) {
+				printf("hex_codec: no SSSE3, vector kernels not tested\n");
+				return;
+			}
+
+			const int lengths[] = {HEX_VECTOR_BYTES, 2 * HEX_VECTOR_BYTES,
+								   2 * HEX_VECTOR_BYTES + 5,
+								   4 * HEX_VECTOR_BYTES};
+
+			for (int n: lengths) {
+				std::vector<unsigned char> bytes(n);
+				this->random_bytes(bytes.data(), n);
+
+				std::string hex;
+				hex_codec::encode(bytes.data(), n, hex);
+
+				for (int trailing_space = 0; trailing_space < 2;
+					 trailing_space++) {
+					std::string dump = hex + (trailing_space ? " " : "");
+
+					std::vector<unsigned char> decoded(n);
+					std::vector<unsigned char> scalar_decoded(n);
+					CHECK(hex_codec::decode(dump, decoded.data(), n));
+					CHECK(hex_codec::decode_scalar(dump,
+												   scalar_decoded.data(), n));
+					CHECK(decoded == bytes);
+					CHECK(scalar_decoded == bytes);
+				}
+			}
+		}
+
+		/**
+		* @fn test_invalid_digits
+		* @brief Puts a char that isn't hex in place of each digit of a
+		*		 dump, in the first vector and in the shifted last one.
+		* @return None.
+		*/
+		void test_invalid_digits() {
+			const int n = 2 * HEX_VECTOR_BYTES;
+			std::vector<unsigned char> bytes(n);
+			this->random_bytes(bytes.data(), n);
+
+			std::string hex;
+			hex_codec::encode(bytes.data(), n, hex);
+
+			const char bad_digits[] = {'g', 'G', ' ', ':', '\0'};
+			std::vector<unsigned char> decoded(n);
+
+			for (size_t pos = 0; pos < hex.size(); pos++) {
+				if (pos % HEX_CHARS_PER_BYTE == HEX_CHARS_PER_BYTE - 1) {
+					continue;
+				}
+
+				for (char bad: bad_digits) {
+					std::string dump = hex;
+					dump[pos] = bad;
+
+					CHECK(!hex_codec::decode(dump, decoded.data(), n));
+					CHECK(!hex_codec::decode_scalar(dump, decoded.data(), n));
+				}
+			}
+		}
+
+		/**
+		* @fn test_upper_case
+		* @brief Decodes digits of both cases.
+		* @return None.
+		*/
+		void test_upper_case() {
+			const std::string hex = "aB Cd EF 09";
+			const unsigned char expected[] = {0xab, 0xcd, 0xef, 0x09};
+			unsigned char decoded[4];
+
+			CHECK(hex_codec::decode(hex, decoded, 4));
+			CHECK(std::equal(decoded, decoded + 4, expected));
+			CHECK(hex_codec::decode_scalar(hex, decoded, 4));
+			CHECK(std::equal(decoded, decoded + 4, expected));
+		}
+
+		/**
+		* @fn test_short_dump
+		* @brief Decodes a dump missing its last digits, which are read
+		*		 as 0 as in the DRAM dump.
+		* @return None.
+		*/
+		void test_short_dump() {
+			const std::string hex = "12 3";
+			const unsigned char expected[] = {0x12, 0x30, 0x00};
+			unsigned char decoded[3];
+
+			CHECK(hex_codec::decode(hex, decoded, 3));
+			CHECK(std::equal(decoded, decoded + 3, expected));
+		}
+};
+
+/**
+* @fn main
+* @brief Runs the tests of hex_codec.
+* @return 0 if they passed, 1 otherwise.
+*/
+int main() {
+	hex_codec_test test(1);
+	test.run_all();
+
+	return unit_test_result("hex_codec");
+}
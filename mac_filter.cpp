@@ -0,0 +1,140 @@
+#include "mac_filter.h"
+#include "common.hpp"
+#include <stdexcept>
+
+using namespace common;
+
+/* Num of bits of a 64 bit product a slot is taken from, at first */
+static const int MIN_SLOTS_BITS = 4;
+
+/**
+* @fn mac_filter
+* @brief Constructor of the class.
+* @return New empty filter, accepts no address.
+*/
+mac_filter::mac_filter() {
+	static_assert((size_t(1) << MIN_SLOTS_BITS) == MAC_FILTER_MIN_SLOTS,
+				  "slots are the top bits of the hash");
+
+	this->slots.assign(MAC_FILTER_MIN_SLOTS, MAC_EMPTY_KEY);
+	this->shift = 64 - MIN_SLOTS_BITS;
+	this->unicast_num = 0;
+	this->multicast_num = 0;
+	this->broadcast = false;
+}
+
+/**
+* @fn add
+* @brief Adds an address to accept. Adding it again does nothing.
+*		 Adding broadcast enables it, see set_broadcast.
+* @param key - The address, see to_key.
+* @return None, throws std::invalid_argument if the key isn't a
+*		  48 bit address.
+*/
+void mac_filter::add(uint64_t key) {
+	if (key > MAC_BROADCAST_KEY) {
+		throw std::invalid_argument("MAC address is longer than 48 bits.");
+	}
+
+	/* broadcast is a flag, accepts checks it before the table */
+	if (key == MAC_BROADCAST_KEY) {
+		this->broadcast = true;
+		return;
+	}
+
+	if (this->accepts(key)) {
+		return;
+	}
+
+	/* at most half full, so probes stay short */
+	if ((this->size() + 1) * 2 > this->slots.size()) {
+		this->grow();
+	}
+
+	this->insert(key);
+
+	if (is_multicast(key)) {
+		this->multicast_num++;
+	} else {
+		this->unicast_num++;
+	}
+}
+
+/**
+* @fn set_broadcast
+* @brief Sets whether the broadcast address is accepted.
+* @param accept - True to accept it.
+* @return None.
+*/
+void mac_filter::set_broadcast(bool accept) {
+	this->broadcast = accept;
+}
+
+/**
+* @fn size
+* @brief Getter to the num of addresses added.
+* @return The num of addresses, broadcast isn't counted.
+*/
+size_t mac_filter::size() const {
+	return this->unicast_num + this->multicast_num;
+}
+
+/**
+* @fn multicast_size
+* @brief Getter to the num of group addresses added.
+* @return The num of group addresses.
+*/
+size_t mac_filter::multicast_size() const {
+	return this->multicast_num;
+}
+
+/**
+* @fn to_key
+* @brief Packs a MAC address into an integer, first byte most
+*		 significant.
+* @param mac[] - The address, MAC_SIZE bytes.
+* @return The key.
+*/
+uint64_t mac_filter::to_key(const uint8_t mac[]) {
+	uint64_t key = 0;
+	for (int i = 0; i < MAC_SIZE; i++) {
+		key = (key << 8) | mac[i];
+	}
+
+	return key;
+}
+
+/**
+* @fn grow
+* @brief Doubles the num of slots and inserts the keys again.
+* @return None.
+*/
+void mac_filter::grow() {
+	std::vector<uint64_t> old_slots(this->slots.size() * 2, MAC_EMPTY_KEY);
+	old_slots.swap(this->slots);
+	this->shift--;
+
+	for (uint64_t key: old_slots) {
+		if (key != MAC_EMPTY_KEY) {
+			this->insert(key);
+		}
+	}
+}
+
+/**
+* @fn insert
+* @brief Puts a key in its slot, the key isn't in the table and
+*		 there is room for it.
+* @param key - The address.
+* @return None.
+*/
+void mac_filter::insert(uint64_t key) {
+	size_t mask = this->slots.size() - 1;
+	size_t slot = this->slot_of(key);
+
+	while (this->slots[slot] != MAC_EMPTY_KEY) {
+		slot = (slot + 1) & mask;
+	}
+
+	this->slots[slot] = key;
+}
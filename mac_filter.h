@@ -0,0 +1,150 @@
+#ifndef __MAC_FILTER__
+#define __MAC_FILTER__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Key of ff:ff:ff:ff:ff:ff */
+const uint64_t MAC_BROADCAST_KEY = 0xffffffffffffULL;
+/* Set in the key of a group (multicast) address, the I/G bit of the
+   first byte */
+const uint64_t MAC_GROUP_BIT = 1ULL << 40;
+/* Marks an empty slot, no MAC has a key this large */
+const uint64_t MAC_EMPTY_KEY = UINT64_MAX;
+/* Num of slots of a new table, a power of 2 */
+const size_t MAC_FILTER_MIN_SLOTS = 16;
+
+/* dst MACs a NIC accepts L2 packets of: its own and any other unicast
+   and multicast addresses, and broadcast if it is enabled. Addresses are
+   kept as 48 bit integer keys in a linear probing table of plain words,
+   at most half full, so a lookup is a multiply and usually a single
+   cache line read. */
+class mac_filter {
+	std::vector<uint64_t> slots;
+	/* the top bits of a key's product are its slot */
+	int shift;
+	size_t unicast_num;
+	size_t multicast_num;
+	bool broadcast;
+
+	/* tests find keys of the same slot */
+	friend class mac_filter_test;
+
+	public:
+
+		/**
+		* @fn mac_filter
+		* @brief Constructor of the class.
+		* @return New empty filter, accepts no address.
+		*/
+		mac_filter();
+
+		/**
+		* @fn add
+		* @brief Adds an address to accept. Adding it again does nothing.
+		*		 Adding broadcast enables it, see set_broadcast.
+		* @param key - The address, see to_key.
+		* @return None, throws std::invalid_argument if the key isn't a
+		*		  48 bit address.
+		*/
+		void add(uint64_t key);
+
+		/**
+		* @fn set_broadcast
+		* @brief Sets whether the broadcast address is accepted.
+		* @param accept - True to accept it.
+		* @return None.
+		*/
+		void set_broadcast(bool accept);
+
+		/**
+		* @fn accepts
+		* @brief Checks whether an address is accepted.
+		* @param key - The address, see to_key.
+		* @return True if it was added, or it is broadcast and broadcast
+		*		  is enabled.
+		*/
+		bool accepts(uint64_t key) const {
+			if (key == MAC_BROADCAST_KEY) {
+				return this->broadcast;
+			}
+
+			size_t mask = this->slots.size() - 1;
+			size_t slot = this->slot_of(key);
+
+			/* the table is never full, a probe ends at an empty slot */
+			while (this->slots[slot] != MAC_EMPTY_KEY) {
+				if (this->slots[slot] == key) {
+					return true;
+				}
+				slot = (slot + 1) & mask;
+			}
+
+			return false;
+		}
+
+		/**
+		* @fn size
+		* @brief Getter to the num of addresses added.
+		* @return The num of addresses, broadcast isn't counted.
+		*/
+		size_t size() const;
+
+		/**
+		* @fn multicast_size
+		* @brief Getter to the num of group addresses added.
+		* @return The num of group addresses.
+		*/
+		size_t multicast_size() const;
+
+		/**
+		* @fn to_key
+		* @brief Packs a MAC address into an integer, first byte most
+		*		 significant.
+		* @param mac[] - The address, MAC_SIZE bytes.
+		* @return The key.
+		*/
+		static uint64_t to_key(const uint8_t mac[]);
+
+		/**
+		* @fn is_multicast
+		* @brief Checks whether an address is a group address.
+		* @param key - The address, see to_key.
+		* @return True if its I/G bit is set, as in broadcast.
+		*/
+		static bool is_multicast(uint64_t key) {
+			return (key & MAC_GROUP_BIT) != 0;
+		}
+
+	private:
+
+		/**
+		* @fn slot_of
+		* @brief Finds the first slot to probe for a key, by Fibonacci
+		*		 hashing: the vendor bytes of many addresses are the same,
+		*		 so the low bits alone are a poor slot.
+		* @param key - The address.
+		* @return The slot.
+		*/
+		size_t slot_of(uint64_t key) const {
+			return (key * 0x9e3779b97f4a7c15ULL) >> this->shift;
+		}
+
+		/**
+		* @fn grow
+		* @brief Doubles the num of slots and inserts the keys again.
+		* @return None.
+		*/
+		void grow();
+
+		/**
+		* @fn insert
+		* @brief Puts a key in its slot, the key isn't in the table and
+		*		 there is room for it.
+		* @param key - The address.
+		* @return None.
+		*/
+		void insert(uint64_t key);
+};
+#endif
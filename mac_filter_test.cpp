@@ -0,0 +1,198 @@
+#include "mac_filter.h"
+#include "common.hpp"
+#include "unit_test.h"
+#include <stdexcept>
+#include <vector>
+
+/* Num of addresses of one vendor added in the growth test */
+const uint64_t TEST_MACS_NUM = 1000;
+/* Key of a vendor's first address */
+const uint64_t TEST_VENDOR_KEY = 0x001a2b000000ULL;
+
+/* Tests of mac_filter, friend of it to find keys of the same slot */
+class mac_filter_test {
+	public:
+
+		/**
+		* @fn run_all
+		* @brief Runs all tests.
+		* @return None.
+		*/
+		void run_all() {
+			this->test_empty();
+			this->test_broadcast();
+			this->test_multicast();
+			this->test_collisions();
+			this->test_growth();
+			this->test_invalid();
+		}
+
+	private:
+
+		/**
+		* @fn colliding_keys
+		* @brief Finds unicast keys that a filter of MAC_FILTER_MIN_SLOTS
+		*		 slots probes from the same slot.
+		* @param slot - The slot.
+		* @param keys_num - Num of keys to find.
+		* @return The keys.
+		*/
+		static std::vector<uint64_t> colliding_keys(size_t slot,
+													size_t keys_num) {
+			mac_filter macs;
+			std::vector<uint64_t> keys;
+
+			for (uint64_t key = TEST_VENDOR_KEY; keys.size() < keys_num;
+				 key++) {
+				if (macs.slot_of(key) == slot) {
+					keys.push_back(key);
+				}
+			}
+
+			return keys;
+		}
+
+		/**
+		* @fn test_empty
+		* @brief A new filter accepts nothing, not even broadcast.
+		* @return None.
+		*/
+		void test_empty() {
+			mac_filter macs;
+			CHECK(!macs.accepts(TEST_VENDOR_KEY));
+			CHECK(!macs.accepts(0));
+			CHECK(!macs.accepts(MAC_BROADCAST_KEY));
+			CHECK(macs.size() == 0);
+		}
+
+		/**
+		* @fn test_broadcast
+		* @brief Broadcast is a flag set by adding it or by set_broadcast,
+		*		 it isn't counted and doesn't accept other addresses.
+		* @return None.
+		*/
+		void test_broadcast() {
+			mac_filter macs;
+			macs.add(MAC_BROADCAST_KEY);
+			CHECK(macs.accepts(MAC_BROADCAST_KEY));
+			CHECK(macs.size() == 0);
+			CHECK(macs.multicast_size() == 0);
+			CHECK(!macs.accepts(MAC_BROADCAST_KEY - 1));
+
+			macs.set_broadcast(false);
+			CHECK(!macs.accepts(MAC_BROADCAST_KEY));
+
+			macs.set_broadcast(true);
+			CHECK(macs.accepts(MAC_BROADCAST_KEY));
+			CHECK(mac_filter::is_multicast(MAC_BROADCAST_KEY));
+		}
+
+		/**
+		* @fn test_multicast
+		* @brief Group addresses are accepted like unicast ones and
+		*		 counted apart, adding one twice counts it once.
+		* @return None.
+		*/
+		void test_multicast() {
+			const uint8_t group[MAC_SIZE] = {0x01, 0x00, 0x5e, 0x00, 0x00,
+											 0xfb};
+			const uint8_t unicast[MAC_SIZE] = {0x00, 0x1a, 0x2b, 0x3c, 0x4d,
+											   0x5e};
+			uint64_t group_key = mac_filter::to_key(group);
+			uint64_t unicast_key = mac_filter::to_key(unicast);
+
+			CHECK(group_key == 0x01005e0000fbULL);
+			CHECK(mac_filter::is_multicast(group_key));
+			CHECK(!mac_filter::is_multicast(unicast_key));
+
+			mac_filter macs;
+			macs.add(group_key);
+			macs.add(group_key);
+			macs.add(unicast_key);
+
+			CHECK(macs.accepts(group_key));
+			CHECK(macs.accepts(unicast_key));
+			CHECK(!macs.accepts(group_key + 1));
+			CHECK(!macs.accepts(MAC_BROADCAST_KEY));
+			CHECK(macs.size() == 2);
+			CHECK(macs.multicast_size() == 1);
+		}
+
+		/**
+		* @fn test_collisions
+		* @brief Keys of the same slot are probed past each other, also
+		*		 from the last slot around to the first.
+		* @return None.
+		*/
+		void test_collisions() {
+			const size_t slots[] = {0, MAC_FILTER_MIN_SLOTS - 1};
+
+			for (size_t slot: slots) {
+				std::vector<uint64_t> keys = colliding_keys(slot, 5);
+				mac_filter macs;
+
+				for (size_t i = 0; i < 4; i++) {
+					macs.add(keys[i]);
+				}
+				CHECK(macs.slots.size() == MAC_FILTER_MIN_SLOTS);
+
+				for (size_t i = 0; i < 4; i++) {
+					CHECK(macs.accepts(keys[i]));
+				}
+				CHECK(!macs.accepts(keys[4]));
+				CHECK(macs.size() == 4);
+			}
+		}
+
+		/**
+		* @fn test_growth
+		* @brief Many addresses of one vendor, so they differ only in the
+		*		 low bytes, stay accepted as the table grows.
+		* @return None.
+		*/
+		void test_growth() {
+			mac_filter macs;
+			for (uint64_t i = 0; i < TEST_MACS_NUM; i++) {
+				macs.add(TEST_VENDOR_KEY + i * 3);
+			}
+
+			CHECK(macs.size() == TEST_MACS_NUM);
+			CHECK(macs.slots.size() >= 2 * TEST_MACS_NUM);
+
+			size_t wrong = 0;
+			for (uint64_t i = 0; i < 3 * TEST_MACS_NUM; i++) {
+				wrong += (macs.accepts(TEST_VENDOR_KEY + i) != (i % 3 == 0));
+			}
+			CHECK(wrong == 0);
+		}
+
+		/**
+		* @fn test_invalid
+		* @brief A key longer than 48 bits throws.
+		* @return None.
+		*/
+		void test_invalid() {
+			mac_filter macs;
+			bool thrown = false;
+			try {
+				macs.add(MAC_BROADCAST_KEY + 1);
+			} catch (const std::invalid_argument &e) {
+				thrown = true;
+			}
+
+			CHECK(thrown);
+			CHECK(macs.size() == 0);
+		}
+};
+
+/**
+* @fn main
+* @brief Runs the tests of mac_filter.
+* @return 0 if they passed, 1 otherwise.
+*/
+int main() {
+	mac_filter_test test;
+	test.run_all();
+
+	return unit_test_result("mac_filter");
+}
@@ -0,0 +1,146 @@
+#ifndef __MPMC_RING__
+#define __MPMC_RING__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "spsc_ring.h"
+
+/* Bounded lock free queue for any number of producer and consumer
+   threads. Every slot has a sequence number telling whether it is free
+   for the push of its round or holds an item for the pop of its round,
+   so a thread claims a slot with a single compare and swap. */
+template <class T>
+class mpmc_ring {
+	struct slot {
+		std::atomic<size_t> seq;
+		T item;
+	};
+
+	std::unique_ptr<slot[]> slots;
+	size_t mask;
+
+	/* next position to push, shared by the producers */
+	char push_pad[CACHE_LINE_SIZE];
+	std::atomic<size_t> push_pos;
+	/* next position to pop, shared by the consumers */
+	char pop_pad[CACHE_LINE_SIZE];
+	std::atomic<size_t> pop_pos;
+	char end_pad[CACHE_LINE_SIZE];
+
+	public:
+
+		/**
+		* @fn mpmc_ring
+		* @brief Constructor of the class.
+		* @param capacity - Min num of items the queue holds, rounded up
+		*		 to a power of 2 (at least 2).
+		* @return New empty queue.
+		*/
+		explicit mpmc_ring(size_t capacity): push_pos(0), pop_pos(0) {
+			size_t size = 2;
+			while (size < capacity) {
+				size <<= 1;
+			}
+
+			this->slots.reset(new slot[size]);
+			this->mask = size - 1;
+
+			for (size_t i = 0; i < size; i++) {
+				this->slots[i].seq.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		mpmc_ring(const mpmc_ring &other) = delete;
+		mpmc_ring& operator=(const mpmc_ring &other) = delete;
+
+		/**
+		* @fn try_push
+		* @brief Adds an item if there is room.
+		* @param item - The item.
+		* @return True if it was added, false if the queue is full.
+		*/
+		bool try_push(const T &item) {
+			size_t pos = this->push_pos.load(std::memory_order_relaxed);
+			slot* target;
+
+			while (true) {
+				target = &this->slots[pos & this->mask];
+				size_t seq = target->seq.load(std::memory_order_acquire);
+				intptr_t diff = intptr_t(seq) - intptr_t(pos);
+
+				if (diff == 0) {
+					if (this->push_pos.compare_exchange_weak(
+							pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (diff < 0) {
+					/* slot still holds the item of the previous round */
+					return false;
+				} else {
+					pos = this->push_pos.load(std::memory_order_relaxed);
+				}
+			}
+
+			target->item = item;
+			target->seq.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		* @fn try_pop
+		* @brief Takes the oldest item if there is one.
+		* @param item[out] - The item.
+		* @return True if an item was taken, false if the queue is empty.
+		*/
+		bool try_pop(T &item) {
+			size_t pos = this->pop_pos.load(std::memory_order_relaxed);
+			slot* target;
+
+			while (true) {
+				target = &this->slots[pos & this->mask];
+				size_t seq = target->seq.load(std::memory_order_acquire);
+				intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+
+				if (diff == 0) {
+					if (this->pop_pos.compare_exchange_weak(
+							pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (diff < 0) {
+					/* slot wasn't pushed to in this round yet */
+					return false;
+				} else {
+					pos = this->pop_pos.load(std::memory_order_relaxed);
+				}
+			}
+
+			item = target->item;
+			target->seq.store(pos + this->mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		* @fn capacity
+		* @brief Getter to the num of items the queue holds.
+		* @return The capacity.
+		*/
+		size_t capacity() const {
+			return this->mask + 1;
+		}
+
+		/**
+		* @fn size
+		* @brief Num of items in the queue. Exact only when no thread is
+		*		 pushing or popping.
+		* @return The num of items.
+		*/
+		size_t size() const {
+			size_t pushed = this->push_pos.load(std::memory_order_acquire);
+			size_t popped = this->pop_pos.load(std::memory_order_acquire);
+
+			return (pushed > popped ? pushed - popped : 0);
+		}
+};
+#endif
@@ -0,0 +1,250 @@
+#include "mpmc_ring.h"
+#include "packet_queue.h"
+#include "unit_test.h"
+#include <thread>
+#include <vector>
+
+/* Num of threads pushing and popping in the stress tests */
+const int TEST_PRODUCERS_NUM = 4;
+const int TEST_CONSUMERS_NUM = 3;
+/* Num of items each producer pushes */
+const size_t TEST_ITEMS_NUM = 50000;
+/* Bits of an item that hold its num, the producer is above them */
+const int TEST_ITEM_BITS = 32;
+
+/**
+* @fn test_full_and_empty
+* @brief Fills a queue, its capacity rounded up to a power of 2 and at
+*		 least 2, and empties it.
+* @return None.
+*/
+static void test_full_and_empty() {
+	mpmc_ring<int> tiny(1);
+	CHECK(tiny.capacity() == 2);
+
+	mpmc_ring<int> ring(5);
+	int item = -1;
+	CHECK(ring.capacity() == 8);
+	CHECK(!ring.try_pop(item));
+	CHECK(item == -1);
+
+	for (int i = 0; i < 8; i++) {
+		CHECK(ring.try_push(i));
+	}
+	CHECK(!ring.try_push(8));
+	CHECK(ring.size() == 8);
+
+	for (int i = 0; i < 8; i++) {
+		CHECK(ring.try_pop(item));
+		CHECK(item == i);
+	}
+	CHECK(!ring.try_pop(item));
+	CHECK(ring.size() == 0);
+}
+
+/**
+* @fn test_wrap_around
+* @brief Pushes and pops 3 items at a time through 4 slots, so the
+*		 sequence numbers of the slots go through many rounds.
+* @return None.
+*/
+static void test_wrap_around() {
+	mpmc_ring<int> ring(4);
+	int next_push = 0;
+	int next_pop = 0;
+
+	for (int round = 0; round < 1000; round++) {
+		for (int i = 0; i < 3; i++) {
+			CHECK(ring.try_push(next_push++));
+		}
+		CHECK(ring.size() == 3);
+
+		for (int i = 0; i < 3; i++) {
+			int item;
+			CHECK(ring.try_pop(item));
+			CHECK(item == next_pop++);
+		}
+	}
+
+	int item;
+	CHECK(!ring.try_pop(item));
+}
+
+/**
+* @fn test_threads
+* @brief Producers push numbered items through a small queue while
+*		 consumers pop them. Each item is popped once, and a consumer
+*		 sees the items of a producer in the order they were pushed.
+* @return None.
+*/
+static void test_threads() {
+	mpmc_ring<uint64_t> ring(64);
+	std::atomic<int> producers_left(TEST_PRODUCERS_NUM);
+	std::vector<std::vector<size_t>> seen(TEST_CONSUMERS_NUM,
+		std::vector<size_t>(TEST_PRODUCERS_NUM * TEST_ITEMS_NUM, 0));
+	std::vector<size_t> out_of_order(TEST_CONSUMERS_NUM, 0);
+	std::vector<std::thread> threads;
+
+	for (int producer = 0; producer < TEST_PRODUCERS_NUM; producer++) {
+		threads.emplace_back([&, producer]() {
+			for (size_t i = 0; i < TEST_ITEMS_NUM; i++) {
+				uint64_t item = (uint64_t(producer) << TEST_ITEM_BITS) | i;
+				while (!ring.try_push(item)) {
+					std::this_thread::yield();
+				}
+			}
+			producers_left--;
+		});
+	}
+
+	for (int consumer = 0; consumer < TEST_CONSUMERS_NUM; consumer++) {
+		threads.emplace_back([&, consumer]() {
+			std::vector<size_t> next(TEST_PRODUCERS_NUM, 0);
+			uint64_t item;
+
+			while (true) {
+				/* read the producers before popping, so an empty queue
+				   after they are done is empty for good */
+				bool done = producers_left.load() == 0;
+				if (!ring.try_pop(item)) {
+					if (done) {
+						break;
+					}
+					std::this_thread::yield();
+					continue;
+				}
+
+				size_t producer = item >> TEST_ITEM_BITS;
+				size_t i = item & ((uint64_t(1) << TEST_ITEM_BITS) - 1);
+				out_of_order[consumer] += (i < next[producer]);
+				next[producer] = i + 1;
+				seen[consumer][producer * TEST_ITEMS_NUM + i]++;
+			}
+		});
+	}
+
+	for (std::thread &thread: threads) {
+		thread.join();
+	}
+
+	size_t lost = 0;
+	size_t repeated = 0;
+	for (size_t item = 0; item < TEST_PRODUCERS_NUM * TEST_ITEMS_NUM;
+		 item++) {
+		size_t times = 0;
+		for (int consumer = 0; consumer < TEST_CONSUMERS_NUM; consumer++) {
+			times += seen[consumer][item];
+		}
+		lost += (times == 0);
+		repeated += (times > 1);
+	}
+
+	CHECK(lost == 0);
+	CHECK(repeated == 0);
+	for (size_t consumer_out_of_order: out_of_order) {
+		CHECK(consumer_out_of_order == 0);
+	}
+	CHECK(ring.size() == 0);
+}
+
+/**
+* @fn test_packet_queue
+* @brief A full packet queue drops at the tail and counts it, and
+*		 pop_batch takes the oldest packets.
+* @return None.
+*/
+static void test_packet_queue() {
+	packet_queue queue(4);
+	packet_record record = packet_record();
+
+	for (uint32_t i = 0; i < 6; i++) {
+		record.addr = i;
+		CHECK(queue.push(record) == (i < 4));
+	}
+
+	queue_stats stats = queue.get_stats();
+	CHECK(stats.pushed == 4);
+	CHECK(stats.dropped == 2);
+	CHECK(stats.size == 4);
+	CHECK(stats.capacity == 4);
+
+	CHECK(queue.pop(record));
+	CHECK(record.addr == 0);
+
+	packet_record records[8];
+	CHECK(queue.pop_batch(records, 8) == 3);
+	for (uint32_t i = 0; i < 3; i++) {
+		CHECK(records[i].addr == i + 1);
+	}
+	CHECK(!queue.pop(record));
+
+	stats = queue.get_stats();
+	CHECK(stats.popped == 4);
+	CHECK(stats.size == 0);
+}
+
+/**
+* @fn test_packet_queue_threads
+* @brief Producers push to a packet queue that consumers drain, every
+*		 packet is either popped or counted as dropped.
+* @return None.
+*/
+static void test_packet_queue_threads() {
+	packet_queue queue(32);
+	std::atomic<int> producers_left(TEST_PRODUCERS_NUM);
+	std::atomic<unsigned long> popped(0);
+	std::vector<std::thread> threads;
+
+	for (int producer = 0; producer < TEST_PRODUCERS_NUM; producer++) {
+		threads.emplace_back([&]() {
+			packet_record record = packet_record();
+			for (size_t i = 0; i < TEST_ITEMS_NUM; i++) {
+				record.addr = i;
+				queue.push(record);
+			}
+			producers_left--;
+		});
+	}
+
+	for (int consumer = 0; consumer < TEST_CONSUMERS_NUM; consumer++) {
+		threads.emplace_back([&]() {
+			packet_record records[16];
+			while (true) {
+				bool done = producers_left.load() == 0;
+				size_t taken = queue.pop_batch(records, 16);
+				popped += taken;
+				if (taken == 0) {
+					if (done) {
+						break;
+					}
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	for (std::thread &thread: threads) {
+		thread.join();
+	}
+
+	queue_stats stats = queue.get_stats();
+	CHECK(stats.pushed + stats.dropped == TEST_PRODUCERS_NUM * TEST_ITEMS_NUM);
+	CHECK(stats.popped == stats.pushed);
+	CHECK(popped.load() == stats.popped);
+	CHECK(stats.size == 0);
+}
+
+/**
+* @fn main
+* @brief Runs the tests of mpmc_ring and packet_queue.
+* @return 0 if they passed, 1 otherwise.
+*/
+int main() {
+	test_full_and_empty();
+	test_wrap_around();
+	test_threads();
+	test_packet_queue();
+	test_packet_queue_threads();
+
+	return unit_test_result("mpmc_ring");
+}
@@ -0,0 +1,21 @@
+#ifndef __NIC_CONTEXT__
+#define __NIC_CONTEXT__
+
+#include "L3.h"
+#include "mac_filter.h"
+#include "route_table.h"
+
+/* Lookup structures a NIC builds once when it is loaded. Packets bound to
+   the NIC use them, read only, instead of deriving them per packet. */
+struct nic_context {
+	/* NIC's open ports by (src, dst) ports */
+	open_port_idx port_idx;
+	/* NIC's local net, from its IP and mask */
+	ipv4_subnet local_net;
+	/* routes of L3 packets by dst IP, empty if the NIC has none */
+	route_table routes;
+	/* dst MACs of L2 packets the NIC accepts, its own MAC included */
+	mac_filter macs;
+};
+
+#endif
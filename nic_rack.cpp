@@ -0,0 +1,178 @@
+#include "nic_rack.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+/**
+* @fn nic_rack
+* @brief Constructor of the class, creates a NIC per file. The
+*		 rack runs on as many threads as the hardware has.
+* @param param_files - Files of the NICs' parameters, see nic_sim.
+* @return New rack object, throws std::invalid_argument if there
+*		  are no files or one can't be read.
+*/
+nic_rack::nic_rack(const std::vector<std::string> &param_files):
+	nic_rack(param_files, std::thread::hardware_concurrency()) {}
+
+/**
+* @fn nic_rack
+* @brief Constructor of the class, creates a NIC per file.
+* @param param_files - Files of the NICs' parameters, see nic_sim.
+* @param workers_num - Num of threads of the rack, 0 runs it
+*		 single threaded as 1 does.
+* @return New rack object, throws std::invalid_argument if there
+*		  are no files or one can't be read.
+*/
+nic_rack::nic_rack(const std::vector<std::string> &param_files,
+				   unsigned int workers_num) {
+	if (param_files.empty()) {
+		throw std::invalid_argument("No NIC parameters files.");
+	}
+
+	/* hardware_concurrency is 0 when it isn't known */
+	this->workers_num = std::max(workers_num, 1u);
+
+	for (const std::string &param_file: param_files) {
+		this->nics.emplace_back(new nic_sim(param_file));
+	}
+}
+
+/**
+* @fn rack_flow
+* @brief Runs all packets in packet_file through the NICs. L2
+*		 packets go only to the NICs accepting their dst MAC, the
+*		 others drop them anyway. L3 and L4 packets go to all
+*		 NICs, a NIC forwards L3 packets of any subnet to TQ.
+* @param packet_file - Name of file containing packets as strings,
+*		 one per line. Empty lines are skipped.
+* @return None.
+*/
+void nic_rack::rack_flow(const std::string &packet_file) {
+	packet_reader file(packet_file);
+	unsigned int workers_num = this->workers_num;
+	/* a thread past the num of NICs would have none to handle */
+	unsigned int nic_workers_num = std::min<size_t>(workers_num,
+													this->nics.size());
+
+	std::vector<str_view> lines(RACK_BATCH_SIZE);
+	std::vector<std::string> lines_copy(file.is_mapped() ?
+										0 : RACK_BATCH_SIZE);
+	std::vector<packet_record> records(RACK_BATCH_SIZE);
+
+	while (true) {
+		int lines_num = nic_sim::read_lines(file, lines.data(),
+											lines_copy.data(),
+											RACK_BATCH_SIZE);
+		if (lines_num == 0) {
+			break;
+		}
+
+		/* parse once for all NICs - each thread takes a contiguous range
+		   of lines */
+		nic_sim::run_workers(workers_num, [&](unsigned int worker) {
+			int begin = lines_num * worker / workers_num;
+			int end = lines_num * (worker + 1) / workers_num;
+
+			for (int i = begin; i < end; i++) {
+				nic_sim::line_to_record(lines[i], records[i]);
+			}
+		});
+
+		/* handle - each thread owns some of the NICs and goes over all
+		   packets for each */
+		nic_sim::run_workers(nic_workers_num, [&](unsigned int worker) {
+			this->handle_nics(worker, nic_workers_num, records.data(),
+							  lines_num);
+		});
+	}
+
+	for (std::unique_ptr<nic_sim> &nic: this->nics) {
+		nic->flush_sinks();
+	}
+}
+
+/**
+* @fn size
+* @brief Getter to the num of NICs.
+* @return The num of NICs.
+*/
+size_t nic_rack::size() const {
+	return this->nics.size();
+}
+
+/**
+* @fn get_nic
+* @brief Getter to a NIC, for its results and stats. Its stats
+*		 count only the packets it was handed.
+* @param nic - Index of the NIC, in the order of the files.
+* @return The NIC.
+*/
+nic_sim& nic_rack::get_nic(size_t nic) {
+	return *this->nics.at(nic);
+}
+
+/**
+* @fn handle_nics
+* @brief Runs a batch through the NICs of a worker: the NICs whose
+*		 index is the worker's modulo the num of workers.
+* @param worker - The worker.
+* @param nic_workers_num - Num of workers handling NICs.
+* @param records[] - The batch's packets.
+* @param records_num - Num of packets.
+* @return None.
+*/
+void nic_rack::handle_nics(unsigned int worker,
+						   unsigned int nic_workers_num,
+						   const packet_record records[],
+						   int records_num) {
+	for (size_t nic = worker; nic < this->nics.size();
+		 nic += nic_workers_num) {
+		handle_batch(*this->nics[nic], records, records_num);
+	}
+}
+
+/**
+* @fn handle_batch
+* @brief Runs the packets of a batch that are meant for a NIC
+*		 through it, a block at a time.
+* @param nic - The NIC.
+* @param records[] - The batch's packets.
+* @param records_num - Num of packets.
+* @return None.
+*/
+void nic_rack::handle_batch(nic_sim &nic,
+							const packet_record records[],
+							int records_num) {
+	std::vector<packet_record> &block = nic.block.records;
+	int block_num = 0;
+
+	for (int i = 0; i < records_num; i++) {
+		if (!is_for(nic, records[i])) {
+			continue;
+		}
+
+		block[block_num++] = records[i];
+
+		if (block_num == CHECKSUM_BLOCK_SIZE) {
+			nic.handle_block(block.data(), block_num);
+			block_num = 0;
+		}
+	}
+
+	nic.handle_block(block.data(), block_num);
+}
+
+/**
+* @fn is_for
+* @brief Checks whether a packet is meant for a NIC.
+* @param nic - The NIC.
+* @param record - The packet.
+* @return True if the NIC should handle the packet.
+*/
+bool nic_rack::is_for(const nic_sim &nic, const packet_record &record) {
+	if (record.layer != LAYER_L2) {
+		return true;
+	}
+
+	return nic.context.macs.accepts(mac_filter::to_key(record.dst_mac.data()));
+}
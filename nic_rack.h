@@ -0,0 +1,117 @@
+#ifndef __NIC_RACK__
+#define __NIC_RACK__
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "NIC_sim.hpp"
+
+/* Num of packets the rack reads and parses before handing them out */
+const int RACK_BATCH_SIZE = 16384;
+
+/* Several NICs fed from one packets file, as separate nic_sim runs over
+   the same file would be. Each line is read and parsed once, then the
+   NICs are dealt out to a bounded num of threads, each handling the
+   packets meant for its NICs in file order. A NIC keeps its own DRAM,
+   RQ and TQ. */
+class nic_rack {
+	std::vector<std::unique_ptr<nic_sim>> nics;
+	/* num of threads that parse the lines and handle the NICs */
+	unsigned int workers_num;
+
+	public:
+
+		/**
+		* @fn nic_rack
+		* @brief Constructor of the class, creates a NIC per file. The
+		*		 rack runs on as many threads as the hardware has.
+		* @param param_files - Files of the NICs' parameters, see nic_sim.
+		* @return New rack object, throws std::invalid_argument if there
+		*		  are no files or one can't be read.
+		*/
+		nic_rack(const std::vector<std::string> &param_files);
+
+		/**
+		* @fn nic_rack
+		* @brief Constructor of the class, creates a NIC per file.
+		* @param param_files - Files of the NICs' parameters, see nic_sim.
+		* @param workers_num - Num of threads of the rack, 0 runs it
+		*		 single threaded as 1 does.
+		* @return New rack object, throws std::invalid_argument if there
+		*		  are no files or one can't be read.
+		*/
+		nic_rack(const std::vector<std::string> &param_files,
+				 unsigned int workers_num);
+
+		nic_rack(const nic_rack &other) = delete;
+		nic_rack& operator=(const nic_rack &other) = delete;
+
+		/**
+		* @fn rack_flow
+		* @brief Runs all packets in packet_file through the NICs. L2
+		*		 packets go only to the NICs accepting their dst MAC, the
+		*		 others drop them anyway. L3 and L4 packets go to all
+		*		 NICs, a NIC forwards L3 packets of any subnet to TQ.
+		* @param packet_file - Name of file containing packets as strings,
+		*		 one per line. Empty lines are skipped.
+		* @return None.
+		*/
+		void rack_flow(const std::string &packet_file);
+
+		/**
+		* @fn size
+		* @brief Getter to the num of NICs.
+		* @return The num of NICs.
+		*/
+		size_t size() const;
+
+		/**
+		* @fn get_nic
+		* @brief Getter to a NIC, for its results and stats. Its stats
+		*		 count only the packets it was handed.
+		* @param nic - Index of the NIC, in the order of the files.
+		* @return The NIC.
+		*/
+		nic_sim& get_nic(size_t nic);
+
+	private:
+
+		/**
+		* @fn handle_nics
+		* @brief Runs a batch through the NICs of a worker: the NICs whose
+		*		 index is the worker's modulo the num of workers.
+		* @param worker - The worker.
+		* @param nic_workers_num - Num of workers handling NICs.
+		* @param records[] - The batch's packets.
+		* @param records_num - Num of packets.
+		* @return None.
+		*/
+		void handle_nics(unsigned int worker,
+						 unsigned int nic_workers_num,
+						 const packet_record records[],
+						 int records_num);
+
+		/**
+		* @fn handle_batch
+		* @brief Runs the packets of a batch that are meant for a NIC
+		*		 through it, a block at a time.
+		* @param nic - The NIC.
+		* @param records[] - The batch's packets.
+		* @param records_num - Num of packets.
+		* @return None.
+		*/
+		static void handle_batch(nic_sim &nic,
+								 const packet_record records[],
+								 int records_num);
+
+		/**
+		* @fn is_for
+		* @brief Checks whether a packet is meant for a NIC.
+		* @param nic - The NIC.
+		* @param record - The packet.
+		* @return True if the NIC should handle the packet.
+		*/
+		static bool is_for(const nic_sim &nic, const packet_record &record);
+};
+#endif
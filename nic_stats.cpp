@@ -0,0 +1,146 @@
+#include "nic_stats.h"
+#include <cstring>
+
+/* Names of the drop reasons, in the order of drop_reason */
+static const char* const DROP_NAMES[DROP_REASONS_NUM] = {
+	"none",
+	"bad_l2_mac",
+	"bad_l2_cs",
+	"bad_l3_cs",
+	"ttl_expired",
+	"local_to_local",
+	"unknown_port",
+	"addr_out_of_range",
+	"route_drop"
+};
+
+/* Names of the stages, in the order of flow_stage */
+static const char* const STAGE_NAMES[FLOW_STAGES_NUM] = {
+	"read",
+	"parse",
+	"validate",
+	"process",
+	"serialize",
+	"enqueue"
+};
+
+/**
+* @fn add
+* @brief Adds the counters of another stats, e.g. of a worker thread.
+* @param other - The stats to add.
+* @return None.
+*/
+void nic_stats::add(const nic_stats &other) {
+	this->packets += other.packets;
+	this->to_dram += other.to_dram;
+	this->to_rq += other.to_rq;
+	this->to_tq += other.to_tq;
+
+	for (int i = 0; i < DROP_REASONS_NUM; i++) {
+		this->drops[i] += other.drops[i];
+	}
+
+	for (int i = 0; i < FLOW_STAGES_NUM; i++) {
+		this->stage_ns[i] += other.stage_ns[i];
+	}
+}
+
+/**
+* @fn dropped
+* @brief Sums the drops of all reasons.
+* @return Num of dropped packets.
+*/
+unsigned long nic_stats::dropped() const {
+	unsigned long sum = 0;
+
+	for (int i = 0; i < DROP_REASONS_NUM; i++) {
+		sum += this->drops[i];
+	}
+
+	return sum;
+}
+
+/**
+* @fn write_json
+* @brief Appends the stats as a JSON object.
+* @param out[out] - The buffer to append the object to.
+* @return None.
+*/
+void nic_stats::write_json(out_buffer &out) const {
+	const char enabled_key[] = "{\"enabled\": ";
+	out.append(enabled_key, sizeof(enabled_key) - 1);
+	if (enabled) {
+		out.append("true", 4);
+	} else {
+		out.append("false", 5);
+	}
+
+	/* all values are numbers, written as "key": value pairs */
+	struct json_field {
+		const char* key;
+		uint64_t value;
+	};
+
+	const json_field counters[] = {
+		{"packets", this->packets},
+		{"to_dram", this->to_dram},
+		{"to_rq", this->to_rq},
+		{"to_tq", this->to_tq},
+		{"dropped", this->dropped()}
+	};
+
+	for (const json_field &field: counters) {
+		out.append(", \"", 3);
+		out.append(field.key, strlen(field.key));
+		out.append("\": ", 3);
+		out.append_uint64(field.value);
+	}
+
+	const char drops_key[] = ", \"drops\": {";
+	out.append(drops_key, sizeof(drops_key) - 1);
+	for (int i = DROP_NONE + 1; i < DROP_REASONS_NUM; i++) {
+		if (i > DROP_NONE + 1) {
+			out.append(", ", 2);
+		}
+
+		out.append('"');
+		out.append(DROP_NAMES[i], strlen(DROP_NAMES[i]));
+		out.append("\": ", 3);
+		out.append_uint64(this->drops[i]);
+	}
+
+	const char stages_key[] = "}, \"stage_ns\": {";
+	out.append(stages_key, sizeof(stages_key) - 1);
+	for (int i = 0; i < FLOW_STAGES_NUM; i++) {
+		if (i > 0) {
+			out.append(", ", 2);
+		}
+
+		out.append('"');
+		out.append(STAGE_NAMES[i], strlen(STAGE_NAMES[i]));
+		out.append("\": ", 3);
+		out.append_uint64(this->stage_ns[i]);
+	}
+
+	out.append("}}", 2);
+}
+
+/**
+* @fn drop_name
+* @brief Getter to the name of a drop reason, as in the JSON.
+* @param reason - The reason.
+* @return The name.
+*/
+const char* nic_stats::drop_name(drop_reason reason) {
+	return DROP_NAMES[reason];
+}
+
+/**
+* @fn stage_name
+* @brief Getter to the name of a stage, as in the JSON.
+* @param stage - The stage.
+* @return The name.
+*/
+const char* nic_stats::stage_name(flow_stage stage) {
+	return STAGE_NAMES[stage];
+}
@@ -0,0 +1,193 @@
+#ifndef __NIC_STATS__
+#define __NIC_STATS__
+
+#include <chrono>
+#include <cstdint>
+#include "common.hpp"
+#include "packets.hpp"
+#include "out_buffer.h"
+
+/* Build with -DNIC_STATS=0 to remove the counters and timers of the flow,
+   nic_stats then stays all zeros */
+#ifndef NIC_STATS
+#define NIC_STATS 1
+#endif
+
+/* Why a packet didn't make it through the NIC */
+enum drop_reason {
+    DROP_NONE,
+    DROP_L2_MAC,
+    DROP_L2_CS,
+    DROP_L3_CS,
+    DROP_TTL_EXPIRED,
+    DROP_LOCAL_TO_LOCAL,
+    DROP_UNKNOWN_PORT,
+    DROP_ADDR_RANGE,
+    DROP_ROUTE,
+    DROP_REASONS_NUM
+};
+
+/* Stages of the flow that are timed */
+enum flow_stage {
+    STAGE_READ,
+    STAGE_PARSE,
+    STAGE_VALIDATE,
+    STAGE_PROCESS,
+    STAGE_SERIALIZE,
+    STAGE_ENQUEUE,
+    FLOW_STAGES_NUM
+};
+
+/* Counters of the packets a NIC handled and the time spent in each stage.
+   A stage run by several threads at once sums the time of all of them. */
+struct nic_stats {
+    static const bool enabled = (NIC_STATS != 0);
+
+    /* packets read */
+    unsigned long packets;
+    /* packets that were processed, by where they were sent */
+    unsigned long to_dram;
+    unsigned long to_rq;
+    unsigned long to_tq;
+    /* packets that were dropped, by reason */
+    unsigned long drops[DROP_REASONS_NUM];
+    /* nanoseconds spent in each stage */
+    uint64_t stage_ns[FLOW_STAGES_NUM];
+
+    nic_stats(): packets(0), to_dram(0), to_rq(0), to_tq(0),
+                 drops(), stage_ns() {}
+
+    /**
+     * @fn count_packets
+     * @brief Counts packets read.
+     * @param n - Num of packets.
+     * @return None.
+     */
+    void count_packets(unsigned long n) {
+#if NIC_STATS
+        this->packets += n;
+#endif
+    }
+
+    /**
+     * @fn count_drop
+     * @brief Counts a dropped packet.
+     * @param reason - Why the packet was dropped.
+     * @return None.
+     */
+    void count_drop(drop_reason reason) {
+#if NIC_STATS
+        this->drops[reason]++;
+#endif
+    }
+
+    /**
+     * @fn count_dst
+     * @brief Counts a processed packet by its destination.
+     * @param dst - Where the packet was sent.
+     * @return None.
+     */
+    void count_dst(memory_dest dst) {
+#if NIC_STATS
+        switch (dst) {
+            case memory_dest::RQ:
+                this->to_rq++;
+                break;
+
+            case memory_dest::TQ:
+                this->to_tq++;
+                break;
+
+            default:
+                this->to_dram++;
+                break;
+        }
+#endif
+    }
+
+    /**
+     * @fn add
+     * @brief Adds the counters of another stats, e.g. of a worker thread.
+     * @param other - The stats to add.
+     * @return None.
+     */
+    void add(const nic_stats &other);
+
+    /**
+     * @fn dropped
+     * @brief Sums the drops of all reasons.
+     * @return Num of dropped packets.
+     */
+    unsigned long dropped() const;
+
+    /**
+     * @fn write_json
+     * @brief Appends the stats as a JSON object.
+     * @param out[out] - The buffer to append the object to.
+     * @return None.
+     */
+    void write_json(out_buffer &out) const;
+
+    /**
+     * @fn drop_name
+     * @brief Getter to the name of a drop reason, as in the JSON.
+     * @param reason - The reason.
+     * @return The name.
+     */
+    static const char* drop_name(drop_reason reason);
+
+    /**
+     * @fn stage_name
+     * @brief Getter to the name of a stage, as in the JSON.
+     * @param stage - The stage.
+     * @return The name.
+     */
+    static const char* stage_name(flow_stage stage);
+};
+
+/* Adds the time from its creation to its destruction to a stage of a
+   nic_stats. Does nothing when NIC_STATS is 0. */
+class stage_timer {
+#if NIC_STATS
+	uint64_t &total;
+	std::chrono::steady_clock::time_point start;
+#endif
+
+	public:
+
+		/**
+		* @fn stage_timer
+		* @brief Constructor of the class, starts the timer.
+		* @param stats - The stats to add the time to, must outlive it.
+		* @param stage - The stage being timed.
+		* @return New timer object.
+		*/
+		stage_timer(nic_stats &stats, flow_stage stage)
+#if NIC_STATS
+			: total(stats.stage_ns[stage]),
+			  start(std::chrono::steady_clock::now())
+#endif
+		{
+#if !NIC_STATS
+			(void)stats;
+			(void)stage;
+#endif
+		}
+
+		stage_timer(const stage_timer &other) = delete;
+		stage_timer& operator=(const stage_timer &other) = delete;
+
+		/**
+		* @fn ~stage_timer
+		* @brief Stops the timer and adds the time to the stage.
+		* @return None.
+		*/
+		~stage_timer() {
+#if NIC_STATS
+			this->total += std::chrono::duration_cast<
+				std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+										  this->start).count();
+#endif
+		}
+};
+#endif
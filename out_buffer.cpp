@@ -0,0 +1,156 @@
+#include "out_buffer.h"
+#include "hex_codec.h"
+#include <algorithm>
+#include <cstring>
+
+/* "00", "01", ... "99" - numbers are written two digits at a time */
+static const char DIGIT_PAIRS[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233"
+	"34353637383940414243444546474849505152535455565758596061626364656667"
+	"6869707172737475767778798081828384858687888990919293949596979899";
+/* 64 bit numbers are split into chunks of this many decimal digits */
+static const int DECIMAL_CHUNK_DIGITS = 9;
+static const uint32_t DECIMAL_CHUNK = 1000000000;
+
+/**
+* @fn out_buffer
+* @brief Constructor of the class.
+* @param capacity - Num of chars to allocate up front.
+* @return New empty buffer.
+*/
+out_buffer::out_buffer(size_t capacity): buf(capacity > 0 ? capacity : 1),
+										 len(0) {}
+
+/**
+* @fn append
+* @brief Appends chars to the buffer.
+* @param str - The chars to append.
+* @param n - Num of chars.
+* @return None.
+*/
+void out_buffer::append(const char* str, size_t n) {
+	memcpy(this->reserve(n), str, n);
+	this->len += n;
+}
+
+/**
+* @fn append
+* @brief Appends a single char to the buffer.
+* @param c - The char to append.
+* @return None.
+*/
+void out_buffer::append(char c) {
+	*this->reserve(1) = c;
+	this->len++;
+}
+
+/**
+* @fn append_uint
+* @brief Appends a number in decimal, without leading zeros.
+* @param num - The number to append.
+* @return None.
+*/
+void out_buffer::append_uint(uint32_t num) {
+	char digits[UINT32_MAX_DIGITS];
+	char* start = digits + UINT32_MAX_DIGITS;
+
+	/* digits are made from the lowest, into the end of the array */
+	while (num >= 100) {
+		uint32_t pair = num % 100;
+		num /= 100;
+		start -= 2;
+		memcpy(start, DIGIT_PAIRS + 2 * pair, 2);
+	}
+
+	if (num >= 10) {
+		start -= 2;
+		memcpy(start, DIGIT_PAIRS + 2 * num, 2);
+	} else {
+		*--start = '0' + num;
+	}
+
+	this->append(start, digits + UINT32_MAX_DIGITS - start);
+}
+
+/**
+* @fn append_uint64
+* @brief Same as append_uint, for 64 bit counters.
+* @param num - The number to append.
+* @return None.
+*/
+void out_buffer::append_uint64(uint64_t num) {
+	if (num <= UINT32_MAX) {
+		this->append_uint(num);
+		return;
+	}
+
+	/* the higher digits first, then the lowest chunk zero padded */
+	this->append_uint64(num / DECIMAL_CHUNK);
+
+	uint32_t low = num % DECIMAL_CHUNK;
+	char digits[DECIMAL_CHUNK_DIGITS];
+	for (int i = DECIMAL_CHUNK_DIGITS - 1; i >= 0; i--) {
+		digits[i] = '0' + low % 10;
+		low /= 10;
+	}
+
+	this->append(digits, DECIMAL_CHUNK_DIGITS);
+}
+
+/**
+* @fn append_hex
+* @brief Appends bytes as a hex dump, see hex_codec::encode.
+* @param bytes[] - The bytes to append.
+* @param bytes_num - Num of bytes.
+* @return None.
+*/
+void out_buffer::append_hex(const unsigned char bytes[], int bytes_num) {
+	if (bytes_num <= 0) {
+		return;
+	}
+
+	char* dst = this->reserve(HEX_CHARS_PER_BYTE * bytes_num);
+	this->len += hex_codec::encode(bytes, bytes_num, dst);
+}
+
+/**
+* @fn data
+* @brief Getter to the chars in the buffer.
+* @return Pointer to the first char, not null terminated.
+*/
+const char* out_buffer::data() const {
+	return this->buf.data();
+}
+
+/**
+* @fn size
+* @brief Getter to the num of chars in the buffer.
+* @return The num of chars.
+*/
+size_t out_buffer::size() const {
+	return this->len;
+}
+
+/**
+* @fn clear
+* @brief Empties the buffer, keeping its memory.
+* @return None.
+*/
+void out_buffer::clear() {
+	this->len = 0;
+}
+
+/**
+* @fn reserve
+* @brief Makes room for more chars at the end of the buffer,
+*		 at least doubling it when it grows.
+* @param n - Num of chars to make room for.
+* @return Pointer to where the next char should be written.
+*/
+char* out_buffer::reserve(size_t n) {
+	if (this->len + n > this->buf.size()) {
+		this->buf.resize(std::max(this->len + n, 2 * this->buf.size()));
+	}
+
+	return this->buf.data() + this->len;
+}
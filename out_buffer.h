@@ -0,0 +1,104 @@
+#ifndef __OUT_BUFFER__
+#define __OUT_BUFFER__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Num of chars an out_buffer holds before it first grows */
+const size_t DEFAULT_OUT_BUFFER_SIZE = 4096;
+/* Max num of decimal digits of a uint32_t */
+const int UINT32_MAX_DIGITS = 10;
+
+/* A growable char buffer that packets are formatted into, field by field.
+   Numbers are written straight into it, so once it is big enough
+   formatting allocates nothing. Clearing keeps the memory. */
+class out_buffer {
+	std::vector<char> buf;
+	size_t len;
+
+	public:
+
+		/**
+		* @fn out_buffer
+		* @brief Constructor of the class.
+		* @param capacity - Num of chars to allocate up front.
+		* @return New empty buffer.
+		*/
+		out_buffer(size_t capacity = DEFAULT_OUT_BUFFER_SIZE);
+
+		/**
+		* @fn append
+		* @brief Appends chars to the buffer.
+		* @param str - The chars to append.
+		* @param n - Num of chars.
+		* @return None.
+		*/
+		void append(const char* str, size_t n);
+
+		/**
+		* @fn append
+		* @brief Appends a single char to the buffer.
+		* @param c - The char to append.
+		* @return None.
+		*/
+		void append(char c);
+
+		/**
+		* @fn append_uint
+		* @brief Appends a number in decimal, without leading zeros.
+		* @param num - The number to append.
+		* @return None.
+		*/
+		void append_uint(uint32_t num);
+
+		/**
+		* @fn append_uint64
+		* @brief Same as append_uint, for 64 bit counters.
+		* @param num - The number to append.
+		* @return None.
+		*/
+		void append_uint64(uint64_t num);
+
+		/**
+		* @fn append_hex
+		* @brief Appends bytes as a hex dump, see hex_codec::encode.
+		* @param bytes[] - The bytes to append.
+		* @param bytes_num - Num of bytes.
+		* @return None.
+		*/
+		void append_hex(const unsigned char bytes[], int bytes_num);
+
+		/**
+		* @fn data
+		* @brief Getter to the chars in the buffer.
+		* @return Pointer to the first char, not null terminated.
+		*/
+		const char* data() const;
+
+		/**
+		* @fn size
+		* @brief Getter to the num of chars in the buffer.
+		* @return The num of chars.
+		*/
+		size_t size() const;
+
+		/**
+		* @fn clear
+		* @brief Empties the buffer, keeping its memory.
+		* @return None.
+		*/
+		void clear();
+
+	private:
+
+		/**
+		* @fn reserve
+		* @brief Makes room for more chars at the end of the buffer,
+		*		 at least doubling it when it grows.
+		* @param n - Num of chars to make room for.
+		* @return Pointer to where the next char should be written.
+		*/
+		char* reserve(size_t n);
+};
+#endif
@@ -0,0 +1,82 @@
+#include "packet_arena.h"
+
+/**
+* @fn packet_arena
+* @brief Constructor of the class. Memory is taken lazily.
+* @return New empty arena.
+*/
+packet_arena::packet_arena() {
+	this->curr_block = 0;
+	this->curr_offset = 0;
+	this->stats = arena_stats();
+}
+
+/**
+* @fn allocate
+* @brief Bump allocates memory from the current block, moving to
+*		 the next block (or taking a new one) when it is full.
+* @param size - Number of bytes to allocate.
+* @param align - Alignment of the allocation, a power of 2.
+* @return Pointer to the allocated memory.
+*/
+void* packet_arena::allocate(size_t size, size_t align) {
+	while (true) {
+		if (this->curr_block == this->blocks.size()) {
+			/* out of blocks, allocations larger than a block get their own */
+			size_t block_size = (size + align > ARENA_BLOCK_SIZE ?
+								 size + align : ARENA_BLOCK_SIZE);
+
+			this->blocks.emplace_back(new char[block_size]);
+			this->blocks_size.push_back(block_size);
+			this->stats.reserved_bytes += block_size;
+			this->curr_offset = 0;
+		}
+
+		char* block = this->blocks[this->curr_block].get();
+		size_t addr = reinterpret_cast<size_t>(block + this->curr_offset);
+		size_t padding = (align - addr % align) % align;
+
+		if (this->curr_offset + padding + size <=
+			this->blocks_size[this->curr_block]) {
+
+			void* mem = block + this->curr_offset + padding;
+			this->curr_offset += padding + size;
+
+			this->stats.allocations++;
+			this->stats.bytes_in_use += padding + size;
+			if (this->stats.bytes_in_use > this->stats.peak_bytes) {
+				this->stats.peak_bytes = this->stats.bytes_in_use;
+			}
+
+			return mem;
+		}
+
+		/* the rest of the block is wasted, count it as in use */
+		this->stats.bytes_in_use += this->blocks_size[this->curr_block] -
+									this->curr_offset;
+		this->curr_block++;
+		this->curr_offset = 0;
+	}
+}
+
+/**
+* @fn reset
+* @brief Releases all allocations at once. Blocks are kept and
+*		 reused by the next allocations.
+* @return None.
+*/
+void packet_arena::reset() {
+	this->curr_block = 0;
+	this->curr_offset = 0;
+	this->stats.bytes_in_use = 0;
+	this->stats.resets++;
+}
+
+/**
+* @fn get_stats
+* @brief Getter to the usage counters of the arena.
+* @return The counters.
+*/
+const arena_stats& packet_arena::get_stats() const {
+	return this->stats;
+}
@@ -0,0 +1,80 @@
+#ifndef __PACKET_ARENA__
+#define __PACKET_ARENA__
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/* Size of each block the arena takes from the heap, in bytes */
+const size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+/* Usage counters of a packet arena */
+struct arena_stats {
+	unsigned long allocations;
+	unsigned long resets;
+	size_t bytes_in_use;
+	size_t peak_bytes;
+	size_t reserved_bytes;
+};
+
+class packet_arena {
+	std::vector<std::unique_ptr<char[]>> blocks;
+	std::vector<size_t> blocks_size;
+	size_t curr_block;
+	size_t curr_offset;
+	arena_stats stats;
+
+	public:
+
+		/**
+		* @fn packet_arena
+		* @brief Constructor of the class. Memory is taken lazily.
+		* @return New empty arena.
+		*/
+		packet_arena();
+
+		packet_arena(const packet_arena &other) = delete;
+		packet_arena& operator=(const packet_arena &other) = delete;
+
+		/**
+		* @fn allocate
+		* @brief Bump allocates memory from the current block, moving to
+		*		 the next block (or taking a new one) when it is full.
+		* @param size - Number of bytes to allocate.
+		* @param align - Alignment of the allocation, a power of 2.
+		* @return Pointer to the allocated memory.
+		*/
+		void* allocate(size_t size, size_t align);
+
+		/**
+		* @fn create
+		* @brief Constructs an object of type T inside the arena.
+		*		 The arena never destructs it, the caller should call
+		*		 the destructor before the arena is reset.
+		* @param args - Arguments to T's constructor.
+		* @return Pointer to the new object.
+		*/
+		template <class T, class... Args>
+		T* create(Args&&... args) {
+			void* mem = this->allocate(sizeof(T), alignof(T));
+			return new (mem) T(std::forward<Args>(args)...);
+		}
+
+		/**
+		* @fn reset
+		* @brief Releases all allocations at once. Blocks are kept and
+		*		 reused by the next allocations.
+		* @return None.
+		*/
+		void reset();
+
+		/**
+		* @fn get_stats
+		* @brief Getter to the usage counters of the arena.
+		* @return The counters.
+		*/
+		const arena_stats& get_stats() const;
+};
+#endif
@@ -0,0 +1,79 @@
+#include "packet_queue.h"
+
+/**
+* @fn packet_queue
+* @brief Constructor of the class.
+* @param capacity - Min num of packets the queue holds, rounded up
+*		 to a power of 2.
+* @return New empty queue.
+*/
+packet_queue::packet_queue(size_t capacity): ring(capacity),
+											  pushed(0),
+											  dropped(0),
+											  popped(0) {}
+
+/**
+* @fn push
+* @brief Adds a packet, or drops it if the queue is full.
+* @param record - The packet.
+* @return True if it was added, false if it was dropped.
+*/
+bool packet_queue::push(const packet_record &record) {
+	if (!this->ring.try_push(record)) {
+		this->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	this->pushed.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+/**
+* @fn pop
+* @brief Takes the oldest packet if there is one.
+* @param record[out] - The packet.
+* @return True if a packet was taken, false if the queue is empty.
+*/
+bool packet_queue::pop(packet_record &record) {
+	if (!this->ring.try_pop(record)) {
+		return false;
+	}
+
+	this->popped.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+/**
+* @fn pop_batch
+* @brief Takes up to max_records of the oldest packets.
+* @param records[out] - Array of max_records packets to fill.
+* @param max_records - Max num of packets to take.
+* @return Num of packets taken.
+*/
+size_t packet_queue::pop_batch(packet_record records[], size_t max_records) {
+	size_t records_num = 0;
+	while (records_num < max_records &&
+		   this->ring.try_pop(records[records_num])) {
+		records_num++;
+	}
+
+	this->popped.fetch_add(records_num, std::memory_order_relaxed);
+	return records_num;
+}
+
+/**
+* @fn get_stats
+* @brief Getter to the counters of the queue. Counters are read one
+*		 by one, so they are consistent only when the queue is idle.
+* @return The counters.
+*/
+queue_stats packet_queue::get_stats() const {
+	queue_stats stats;
+	stats.pushed = this->pushed.load(std::memory_order_relaxed);
+	stats.dropped = this->dropped.load(std::memory_order_relaxed);
+	stats.popped = this->popped.load(std::memory_order_relaxed);
+	stats.size = this->ring.size();
+	stats.capacity = this->ring.capacity();
+
+	return stats;
+}
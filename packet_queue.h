@@ -0,0 +1,81 @@
+#ifndef __PACKET_QUEUE__
+#define __PACKET_QUEUE__
+
+#include <atomic>
+#include <cstddef>
+#include "packet_record.h"
+#include "mpmc_ring.h"
+
+/* Default num of packets a NIC queue holds */
+const size_t DEFAULT_QUEUE_CAPACITY = 4096;
+
+/* Counters of a NIC queue */
+struct queue_stats {
+	/* packets added to the queue */
+	unsigned long pushed;
+	/* packets dropped because the queue was full */
+	unsigned long dropped;
+	/* packets taken out of the queue */
+	unsigned long popped;
+	/* packets in the queue */
+	size_t size;
+	size_t capacity;
+};
+
+/* Fixed capacity NIC queue (RQ or TQ) of processed packets, kept as packet
+   records. Like a real NIC ring, a packet that arrives when the queue is
+   full is dropped at the tail. Any number of threads may push and pop. */
+class packet_queue {
+	mpmc_ring<packet_record> ring;
+
+	char producers_pad[CACHE_LINE_SIZE];
+	std::atomic<unsigned long> pushed;
+	std::atomic<unsigned long> dropped;
+	char consumers_pad[CACHE_LINE_SIZE];
+	std::atomic<unsigned long> popped;
+
+	public:
+
+		/**
+		* @fn packet_queue
+		* @brief Constructor of the class.
+		* @param capacity - Min num of packets the queue holds, rounded up
+		*		 to a power of 2.
+		* @return New empty queue.
+		*/
+		explicit packet_queue(size_t capacity = DEFAULT_QUEUE_CAPACITY);
+
+		/**
+		* @fn push
+		* @brief Adds a packet, or drops it if the queue is full.
+		* @param record - The packet.
+		* @return True if it was added, false if it was dropped.
+		*/
+		bool push(const packet_record &record);
+
+		/**
+		* @fn pop
+		* @brief Takes the oldest packet if there is one.
+		* @param record[out] - The packet.
+		* @return True if a packet was taken, false if the queue is empty.
+		*/
+		bool pop(packet_record &record);
+
+		/**
+		* @fn pop_batch
+		* @brief Takes up to max_records of the oldest packets.
+		* @param records[out] - Array of max_records packets to fill.
+		* @param max_records - Max num of packets to take.
+		* @return Num of packets taken.
+		*/
+		size_t pop_batch(packet_record records[], size_t max_records);
+
+		/**
+		* @fn get_stats
+		* @brief Getter to the counters of the queue. Counters are read one
+		*		 by one, so they are consistent only when the queue is idle.
+		* @return The counters.
+		*/
+		queue_stats get_stats() const;
+};
+#endif
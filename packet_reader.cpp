@@ -0,0 +1,156 @@
+#include "packet_reader.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+* @fn packet_reader
+* @brief Constructor of the class, opens and maps the file.
+* @param file_name - Name of the packets file.
+* @return New reader object, throws std::invalid_argument if the
+*		  file can't be opened.
+*/
+packet_reader::packet_reader(const std::string &file_name) {
+	this->map = nullptr;
+	this->map_len = 0;
+	this->map_pos = 0;
+	this->buf_start = 0;
+	this->buf_end = 0;
+	this->eof = false;
+
+	this->fd = open(file_name.c_str(), O_RDONLY);
+	if (this->fd < 0) {
+		throw std::invalid_argument("Could not open the file.");
+	}
+
+	struct stat file_stat;
+	if (fstat(this->fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+		file_stat.st_size > 0) {
+
+		void* mem = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE,
+						 this->fd, 0);
+
+		if (mem != MAP_FAILED) {
+			this->map = static_cast<const char*>(mem);
+			this->map_len = file_stat.st_size;
+			madvise(mem, this->map_len, MADV_SEQUENTIAL);
+			return;
+		}
+	}
+
+	/* not a regular file, or mapping failed - read through a buffer */
+	this->buffer.resize(READER_BUFFER_SIZE);
+}
+
+/**
+* @fn next_line
+* @brief Gets the next line of the file, without its '\n'.
+* @param line[out] - View of the line. If is_mapped, it is valid
+*		 as long as the reader, otherwise until the next call.
+* @return True if a line was read, false at end of file.
+*/
+bool packet_reader::next_line(str_view &line) {
+	if (this->is_mapped()) {
+		if (this->map_pos >= this->map_len) {
+			return false;
+		}
+
+		const char* start = this->map + this->map_pos;
+		size_t left = this->map_len - this->map_pos;
+		const char* end = static_cast<const char*>(memchr(start, '\n', left));
+
+		size_t len = (end == nullptr ? left : end - start);
+		line = str_view(start, len);
+		this->map_pos += len + 1;
+
+		return true;
+	}
+
+	while (true) {
+		char* start = this->buffer.data() + this->buf_start;
+		size_t left = this->buf_end - this->buf_start;
+		char* end = static_cast<char*>(memchr(start, '\n', left));
+
+		if (end != nullptr) {
+			line = str_view(start, end - start);
+			this->buf_start += end - start + 1;
+			return true;
+		}
+
+		if (!this->fill_buffer()) {
+			/* last line has no '\n' */
+			if (left == 0) {
+				return false;
+			}
+
+			line = str_view(this->buffer.data() + this->buf_start, left);
+			this->buf_start = this->buf_end;
+			return true;
+		}
+	}
+}
+
+/**
+* @fn is_mapped
+* @brief Checks whether the file is mapped to memory.
+* @return True if mapped, false if read through a buffer.
+*/
+bool packet_reader::is_mapped() const {
+	return this->map != nullptr;
+}
+
+/**
+* @fn ~packet_reader
+* @brief Unmaps and closes the file.
+* @return None.
+*/
+packet_reader::~packet_reader() {
+	if (this->map != nullptr) {
+		munmap(const_cast<char*>(this->map), this->map_len);
+	}
+
+	close(this->fd);
+}
+
+/**
+* @fn fill_buffer
+* @brief Moves the unread part of the buffer to its start and reads
+*		 more of the file after it, growing the buffer if it is full.
+* @return True if anything was read, false at end of file.
+*/
+bool packet_reader::fill_buffer() {
+	if (this->eof) {
+		return false;
+	}
+
+	size_t left = this->buf_end - this->buf_start;
+	memmove(this->buffer.data(), this->buffer.data() + this->buf_start, left);
+	this->buf_start = 0;
+	this->buf_end = left;
+
+	if (this->buf_end == this->buffer.size()) {
+		this->buffer.resize(this->buffer.size() * 2);
+	}
+
+	while (true) {
+		ssize_t read_len = read(this->fd,
+								this->buffer.data() + this->buf_end,
+								this->buffer.size() - this->buf_end);
+
+		if (read_len > 0) {
+			this->buf_end += read_len;
+			return true;
+		}
+
+		if (read_len < 0 && errno == EINTR) {
+			continue;
+		}
+
+		this->eof = true;
+		return false;
+	}
+}
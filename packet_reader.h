@@ -0,0 +1,73 @@
+#ifndef __PACKET_READER__
+#define __PACKET_READER__
+
+#include <string>
+#include <vector>
+#include "tokenizer.h"
+
+/* Size of the buffer used when the file can't be mapped, in bytes */
+const size_t READER_BUFFER_SIZE = 1 << 20;
+
+/* Reads a packets file line by line. Regular files are mapped to memory
+   and lines are views straight into the mapping, other files (e.g. pipes)
+   are read through a buffer. */
+class packet_reader {
+	int fd;
+
+	const char* map;
+	size_t map_len;
+	size_t map_pos;
+
+	std::vector<char> buffer;
+	size_t buf_start;
+	size_t buf_end;
+	bool eof;
+
+	public:
+
+		/**
+		* @fn packet_reader
+		* @brief Constructor of the class, opens and maps the file.
+		* @param file_name - Name of the packets file.
+		* @return New reader object, throws std::invalid_argument if the
+		*		  file can't be opened.
+		*/
+		packet_reader(const std::string &file_name);
+
+		packet_reader(const packet_reader &other) = delete;
+		packet_reader& operator=(const packet_reader &other) = delete;
+
+		/**
+		* @fn next_line
+		* @brief Gets the next line of the file, without its '\n'.
+		* @param line[out] - View of the line. If is_mapped, it is valid
+		*		 as long as the reader, otherwise until the next call.
+		* @return True if a line was read, false at end of file.
+		*/
+		bool next_line(str_view &line);
+
+		/**
+		* @fn is_mapped
+		* @brief Checks whether the file is mapped to memory.
+		* @return True if mapped, false if read through a buffer.
+		*/
+		bool is_mapped() const;
+
+		/**
+		* @fn ~packet_reader
+		* @brief Unmaps and closes the file.
+		* @return None.
+		*/
+		~packet_reader();
+
+	private:
+
+		/**
+		* @fn fill_buffer
+		* @brief Moves the unread part of the buffer to its start and reads
+		*		 more of the file after it, growing the buffer if it is full.
+		* @return True if anything was read, false at end of file.
+		*/
+		bool fill_buffer();
+};
+#endif
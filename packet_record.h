@@ -0,0 +1,40 @@
+#ifndef __PACKET_RECORD__
+#define __PACKET_RECORD__
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "common.hpp"
+
+/* Size of data in L5 packet */
+const int DATA_L5_SIZE = 32;
+
+/* The outermost layer of a packet */
+enum packet_layer {
+    LAYER_L4,
+    LAYER_L3,
+    LAYER_L2
+};
+
+/* Flat, fixed size representation of a parsed packet of any layer.
+   Properties of layers above 'layer' are zero. */
+struct packet_record {
+    uint32_t addr;
+    uint32_t ttl;
+    uint32_t L3_cs;
+    uint32_t L2_cs;
+    uint16_t src_port;
+    uint16_t dst_port;
+    std::array<uint8_t, IP_V4_SIZE> src_ip;
+    std::array<uint8_t, IP_V4_SIZE> dst_ip;
+    std::array<uint8_t, MAC_SIZE> src_mac;
+    std::array<uint8_t, MAC_SIZE> dst_mac;
+    uint8_t layer;
+    std::array<uint8_t, 3> reserved;
+    std::array<uint8_t, DATA_L5_SIZE> data;
+};
+
+static_assert(std::is_trivially_copyable<packet_record>::value,
+              "packet_record must be copyable as raw bytes");
+
+#endif
@@ -0,0 +1,89 @@
+#include "packet_trace.h"
+#include <stdexcept>
+
+/**
+* @fn trace_writer
+* @brief Constructor of the class, creates the file and its header.
+* @param file_name - Name of the trace file.
+* @return New writer object, throws std::invalid_argument if the
+*		  file can't be created.
+*/
+trace_writer::trace_writer(const std::string &file_name):
+	file(file_name, std::ios::binary | std::ios::trunc) {
+
+	if (!this->file.is_open()) {
+		throw std::invalid_argument("Could not open the file.");
+	}
+
+	trace_header header;
+	header.magic = TRACE_MAGIC;
+	header.version = TRACE_VERSION;
+	header.byte_order = TRACE_BYTE_ORDER;
+	header.record_size = sizeof(packet_record);
+
+	this->file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+/**
+* @fn write
+* @brief Appends records to the trace.
+* @param records[] - The records to append.
+* @param records_num - Num of records.
+* @return None.
+*/
+void trace_writer::write(const packet_record records[], size_t records_num) {
+	this->file.write(reinterpret_cast<const char*>(records),
+					 records_num * sizeof(packet_record));
+
+	if (!this->file) {
+		throw std::runtime_error("Could not write to the trace.");
+	}
+}
+
+/**
+* @fn trace_reader
+* @brief Constructor of the class, opens the file and checks that
+*		 its header matches this build.
+* @param file_name - Name of the trace file.
+* @return New reader object, throws std::invalid_argument if the
+*		  file can't be opened or isn't a matching trace.
+*/
+trace_reader::trace_reader(const std::string &file_name):
+	file(file_name, std::ios::binary) {
+
+	if (!this->file.is_open()) {
+		throw std::invalid_argument("Could not open the file.");
+	}
+
+	trace_header header;
+	this->file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!this->file || header.magic != TRACE_MAGIC) {
+		throw std::invalid_argument("Not a packet trace.");
+	}
+
+	if (header.version != TRACE_VERSION ||
+		header.byte_order != TRACE_BYTE_ORDER ||
+		header.record_size != sizeof(packet_record)) {
+		throw std::invalid_argument("Packet trace of another format.");
+	}
+}
+
+/**
+* @fn read
+* @brief Reads the next records of the trace.
+* @param records[out] - Where to write the records.
+* @param max_records - Max num of records to read.
+* @return Num of records read, 0 at end of trace.
+*/
+size_t trace_reader::read(packet_record records[], size_t max_records) {
+	this->file.read(reinterpret_cast<char*>(records),
+					max_records * sizeof(packet_record));
+
+	size_t read_len = this->file.gcount();
+	if (read_len % sizeof(packet_record) != 0) {
+		throw std::invalid_argument("Packet trace is truncated.");
+	}
+
+	return read_len / sizeof(packet_record);
+}
@@ -0,0 +1,75 @@
+#ifndef __PACKET_TRACE__
+#define __PACKET_TRACE__
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "packet_record.h"
+
+/* Identifies binary trace files, "NICT" */
+const uint32_t TRACE_MAGIC = 0x5443494e;
+/* Version of the binary trace format */
+const uint32_t TRACE_VERSION = 1;
+/* Written in host order, tells if a trace was made on another endianness */
+const uint32_t TRACE_BYTE_ORDER = 0x01020304;
+
+/* Header at the start of a binary trace, followed by packet_record
+   entries of record_size bytes each, in host byte order. */
+struct trace_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t record_size;
+};
+
+/* Writes packet records to a binary trace file */
+class trace_writer {
+	std::ofstream file;
+
+	public:
+
+		/**
+		* @fn trace_writer
+		* @brief Constructor of the class, creates the file and its header.
+		* @param file_name - Name of the trace file.
+		* @return New writer object, throws std::invalid_argument if the
+		*		  file can't be created.
+		*/
+		trace_writer(const std::string &file_name);
+
+		/**
+		* @fn write
+		* @brief Appends records to the trace.
+		* @param records[] - The records to append.
+		* @param records_num - Num of records.
+		* @return None.
+		*/
+		void write(const packet_record records[], size_t records_num);
+};
+
+/* Reads packet records from a binary trace file */
+class trace_reader {
+	std::ifstream file;
+
+	public:
+
+		/**
+		* @fn trace_reader
+		* @brief Constructor of the class, opens the file and checks that
+		*		 its header matches this build.
+		* @param file_name - Name of the trace file.
+		* @return New reader object, throws std::invalid_argument if the
+		*		  file can't be opened or isn't a matching trace.
+		*/
+		trace_reader(const std::string &file_name);
+
+		/**
+		* @fn read
+		* @brief Reads the next records of the trace.
+		* @param records[out] - Where to write the records.
+		* @param max_records - Max num of records to read.
+		* @return Num of records read, 0 at end of trace.
+		*/
+		size_t read(packet_record records[], size_t max_records);
+};
+#endif
@@ -0,0 +1,245 @@
+#include "parse_cache.h"
+#include <cstring>
+
+/* Index of no entry, ends the recently used list */
+static const uint32_t NO_SLOT = UINT32_MAX;
+/* Odd 64 bit constants of the line hash, one per lane */
+static const uint64_t HASH_SEED = 0x9e3779b97f4a7c15ULL;
+static const uint64_t HASH_MULT = 0xff51afd7ed558ccdULL;
+static const uint64_t HASH_MULT2 = 0xc4ceb9fe1a85ec53ULL;
+/* The index has at least this many buckets per entry */
+static const size_t INDEX_LOAD_FACTOR = 2;
+
+/**
+* @fn parse_cache
+* @brief Constructor of the class. Entries are taken lazily.
+* @param capacity - Max num of lines to keep, at least 1.
+* @return New empty cache.
+*/
+parse_cache::parse_cache(size_t capacity) {
+	this->capacity = (capacity > 0 ? capacity : 1);
+
+	size_t buckets_num = 1;
+	while (buckets_num < INDEX_LOAD_FACTOR * this->capacity) {
+		buckets_num *= 2;
+	}
+	bucket empty = {0, NO_SLOT};
+	this->index.assign(buckets_num, empty);
+	this->index_mask = buckets_num - 1;
+
+	this->head = NO_SLOT;
+	this->tail = NO_SLOT;
+	this->stats = parse_cache_stats();
+}
+
+/**
+* @fn find
+* @brief Looks a line up, making it the most recently used.
+* @param line - The packet line.
+* @param hash - Hash of the line, see hash_line.
+* @param record[out] - The line's record, if found.
+* @return True if the line is cached, false otherwise.
+*/
+bool parse_cache::find(str_view line, uint64_t hash, packet_record &record) {
+	this->stats.lookups++;
+
+	uint32_t slot = this->index[this->probe(hash)].slot;
+	if (slot == NO_SLOT) {
+		return false;
+	}
+
+	const std::string &cached = this->entries[slot].line;
+	if (cached.size() != line.len ||
+		memcmp(cached.data(), line.ptr, line.len) != 0) {
+		this->stats.collisions++;
+		return false;
+	}
+
+	if (slot != this->head) {
+		this->unlink(slot);
+		this->push_front(slot);
+	}
+
+	record = this->entries[slot].record;
+	this->stats.hits++;
+	return true;
+}
+
+/**
+* @fn insert
+* @brief Caches the record of a line that find missed, evicting
+*		 the least recently used line if the cache is full.
+* @param line - The packet line.
+* @param hash - Hash of the line, see hash_line.
+* @param record - The line parsed to a record.
+* @return None.
+*/
+void parse_cache::insert(str_view line, uint64_t hash,
+						 const packet_record &record) {
+	size_t pos = this->probe(hash);
+	uint32_t slot = this->index[pos].slot;
+
+	if (slot != NO_SLOT) {
+		/* a colliding line takes the place of the cached one */
+		this->unlink(slot);
+	} else {
+		if (this->entries.size() < this->capacity) {
+			slot = this->entries.size();
+			this->entries.emplace_back();
+		} else {
+			slot = this->tail;
+			this->unlink(slot);
+			this->erase_bucket(this->probe(this->entries[slot].hash));
+			this->stats.evictions++;
+
+			/* erasing may have moved the hash's empty bucket back */
+			pos = this->probe(hash);
+		}
+
+		this->index[pos].hash = hash;
+		this->index[pos].slot = slot;
+	}
+
+	entry &cached = this->entries[slot];
+	cached.hash = hash;
+	cached.line.assign(line.ptr, line.len);
+	cached.record = record;
+
+	this->push_front(slot);
+	this->stats.inserts++;
+}
+
+/**
+* @fn get_stats
+* @brief Getter to the usage counters of the cache.
+* @return The counters.
+*/
+const parse_cache_stats& parse_cache::get_stats() const {
+	return this->stats;
+}
+
+/**
+* @fn hash_line
+* @brief Hashes a packet line, 16 bytes at a time.
+* @param line - The packet line.
+* @return The hash.
+*/
+uint64_t parse_cache::hash_line(str_view line) {
+	/* two independent lanes, so their multiplications overlap */
+	uint64_t hash = HASH_SEED ^ line.len;
+	uint64_t hash2 = HASH_SEED;
+	size_t i = 0;
+
+	for (; i + 2 * sizeof(uint64_t) <= line.len; i += 2 * sizeof(uint64_t)) {
+		uint64_t words[2];
+		memcpy(words, line.ptr + i, sizeof(words));
+
+		hash = (hash ^ words[0]) * HASH_MULT;
+		hash2 = (hash2 ^ words[1]) * HASH_MULT2;
+	}
+
+	/* the last bytes are zero padded to two words */
+	uint64_t words[2] = {0, 0};
+	memcpy(words, line.ptr + i, line.len - i);
+	hash = (hash ^ words[0]) * HASH_MULT;
+	hash2 = (hash2 ^ words[1]) * HASH_MULT2;
+
+	/* high bits of the lanes are the mixed ones, folded down */
+	hash ^= (hash2 >> 29) ^ (hash2 << 35);
+	hash = (hash ^ (hash >> 32)) * HASH_MULT;
+
+	return hash ^ (hash >> 29);
+}
+
+/**
+* @fn probe
+* @brief Finds the bucket of a hash in the index.
+* @param hash - The hash.
+* @return Position of the hash's bucket, or of the empty bucket
+*		  it would be put in.
+*/
+size_t parse_cache::probe(uint64_t hash) const {
+	size_t pos = hash & this->index_mask;
+
+	while (this->index[pos].slot != NO_SLOT && this->index[pos].hash != hash) {
+		pos = (pos + 1) & this->index_mask;
+	}
+
+	return pos;
+}
+
+/**
+* @fn erase_bucket
+* @brief Empties a bucket of the index, moving back the buckets
+*		 after it that were probed past it.
+* @param pos - Position of the bucket.
+* @return None.
+*/
+void parse_cache::erase_bucket(size_t pos) {
+	size_t next = pos;
+
+	while (true) {
+		this->index[pos].slot = NO_SLOT;
+
+		/* a bucket can fill the hole if its home isn't in (pos, next] */
+		while (true) {
+			next = (next + 1) & this->index_mask;
+			if (this->index[next].slot == NO_SLOT) {
+				return;
+			}
+
+			size_t home = this->index[next].hash & this->index_mask;
+			bool stays = (pos <= next ? (pos < home && home <= next) :
+										(pos < home || home <= next));
+			if (!stays) {
+				break;
+			}
+		}
+
+		this->index[pos] = this->index[next];
+		pos = next;
+	}
+}
+
+/**
+* @fn unlink
+* @brief Takes an entry out of the recently used list.
+* @param slot - Index of the entry.
+* @return None.
+*/
+void parse_cache::unlink(uint32_t slot) {
+	entry &cached = this->entries[slot];
+
+	if (cached.prev != NO_SLOT) {
+		this->entries[cached.prev].next = cached.next;
+	} else {
+		this->head = cached.next;
+	}
+
+	if (cached.next != NO_SLOT) {
+		this->entries[cached.next].prev = cached.prev;
+	} else {
+		this->tail = cached.prev;
+	}
+}
+
+/**
+* @fn push_front
+* @brief Links an entry as the most recently used.
+* @param slot - Index of the entry.
+* @return None.
+*/
+void parse_cache::push_front(uint32_t slot) {
+	entry &cached = this->entries[slot];
+
+	cached.prev = NO_SLOT;
+	cached.next = this->head;
+
+	if (this->head != NO_SLOT) {
+		this->entries[this->head].prev = slot;
+	} else {
+		this->tail = slot;
+	}
+
+	this->head = slot;
+}
@@ -0,0 +1,149 @@
+#ifndef __PARSE_CACHE__
+#define __PARSE_CACHE__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "packet_record.h"
+#include "tokenizer.h"
+
+/* Num of lines a parse cache keeps by default */
+const size_t DEFAULT_PARSE_CACHE_SIZE = 4096;
+
+/* Usage counters of a parse cache */
+struct parse_cache_stats {
+	unsigned long lookups;
+	unsigned long hits;
+	unsigned long inserts;
+	unsigned long evictions;
+	/* lines whose hash matched a cached line that is different */
+	unsigned long collisions;
+
+	/**
+	* @fn hit_rate
+	* @brief Share of lookups that found their line.
+	* @return The rate in [0, 1], 0 if nothing was looked up.
+	*/
+	double hit_rate() const {
+		return (this->lookups > 0 ? double(this->hits) / this->lookups : 0);
+	}
+};
+
+/* Least recently used cache of packet lines already parsed to records,
+   for traces that repeat the same packets. Lines are found by their
+   hash and compared in full, so a collision is a miss, never a wrong
+   record. Not thread safe. */
+class parse_cache {
+	/* entries are linked from the most to the least recently used */
+	struct entry {
+		uint64_t hash;
+		std::string line;
+		packet_record record;
+		uint32_t prev;
+		uint32_t next;
+	};
+
+	/* slot of the open addressing index, the hash is kept next to the
+	   entry's index so probing doesn't touch the entries */
+	struct bucket {
+		uint64_t hash;
+		uint32_t slot;
+	};
+
+	std::vector<entry> entries;
+	/* linear probing index of the entries, at most half full */
+	std::vector<bucket> index;
+	size_t index_mask;
+	size_t capacity;
+	uint32_t head;
+	uint32_t tail;
+	parse_cache_stats stats;
+
+	public:
+
+		/**
+		* @fn parse_cache
+		* @brief Constructor of the class. Entries are taken lazily.
+		* @param capacity - Max num of lines to keep, at least 1.
+		* @return New empty cache.
+		*/
+		parse_cache(size_t capacity = DEFAULT_PARSE_CACHE_SIZE);
+
+		parse_cache(const parse_cache &other) = delete;
+		parse_cache& operator=(const parse_cache &other) = delete;
+
+		/**
+		* @fn find
+		* @brief Looks a line up, making it the most recently used.
+		* @param line - The packet line.
+		* @param hash - Hash of the line, see hash_line.
+		* @param record[out] - The line's record, if found.
+		* @return True if the line is cached, false otherwise.
+		*/
+		bool find(str_view line, uint64_t hash, packet_record &record);
+
+		/**
+		* @fn insert
+		* @brief Caches the record of a line that find missed, evicting
+		*		 the least recently used line if the cache is full.
+		* @param line - The packet line.
+		* @param hash - Hash of the line, see hash_line.
+		* @param record - The line parsed to a record.
+		* @return None.
+		*/
+		void insert(str_view line, uint64_t hash,
+					const packet_record &record);
+
+		/**
+		* @fn get_stats
+		* @brief Getter to the usage counters of the cache.
+		* @return The counters.
+		*/
+		const parse_cache_stats& get_stats() const;
+
+		/**
+		* @fn hash_line
+		* @brief Hashes a packet line, 16 bytes at a time.
+		* @param line - The packet line.
+		* @return The hash.
+		*/
+		static uint64_t hash_line(str_view line);
+
+	private:
+
+		/**
+		* @fn probe
+		* @brief Finds the bucket of a hash in the index.
+		* @param hash - The hash.
+		* @return Position of the hash's bucket, or of the empty bucket
+		*		  it would be put in.
+		*/
+		size_t probe(uint64_t hash) const;
+
+		/**
+		* @fn erase_bucket
+		* @brief Empties a bucket of the index, moving back the buckets
+		*		 after it that were probed past it.
+		* @param pos - Position of the bucket.
+		* @return None.
+		*/
+		void erase_bucket(size_t pos);
+
+		/**
+		* @fn unlink
+		* @brief Takes an entry out of the recently used list.
+		* @param slot - Index of the entry.
+		* @return None.
+		*/
+		void unlink(uint32_t slot);
+
+		/**
+		* @fn push_front
+		* @brief Links an entry as the most recently used.
+		* @param slot - Index of the entry.
+		* @return None.
+		*/
+		void push_front(uint32_t slot);
+};
+#endif
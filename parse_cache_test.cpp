@@ -0,0 +1,201 @@
+#include "parse_cache.h"
+#include "unit_test.h"
+#include <algorithm>
+#include <list>
+#include <string>
+
+/* Num of random lookups of the test against a list */
+const int TEST_LOOKUPS_NUM = 50000;
+/* Num of different lines they look up */
+const int TEST_LINES_NUM = 40;
+
+/**
+* @fn record_of
+* @brief Makes a record told apart by its addr.
+* @param id - The addr.
+* @return The record.
+*/
+static packet_record record_of(uint32_t id) {
+	packet_record record = packet_record();
+	record.addr = id;
+
+	return record;
+}
+
+/**
+* @fn cached_id
+* @brief Looks a line up in a cache.
+* @param cache - The cache.
+* @param line - The line.
+* @return The addr of the line's record, -1 if it isn't cached.
+*/
+static long cached_id(parse_cache &cache, const std::string &line) {
+	packet_record record;
+	if (!cache.find(line, parse_cache::hash_line(line), record)) {
+		return -1;
+	}
+
+	return record.addr;
+}
+
+/**
+* @fn add
+* @brief Caches a line with its hash.
+* @param cache - The cache.
+* @param line - The line.
+* @param id - The addr of its record.
+* @return None.
+*/
+static void add(parse_cache &cache, const std::string &line, uint32_t id) {
+	cache.insert(line, parse_cache::hash_line(line), record_of(id));
+}
+
+/**
+* @fn test_eviction_order
+* @brief The least recently used line is evicted, where finding a line
+*		 uses it.
+* @return None.
+*/
+static void test_eviction_order() {
+	parse_cache cache(3);
+	add(cache, "a", 1);
+	add(cache, "b", 2);
+	add(cache, "c", 3);
+
+	/* order is now a, c, b from the most recently used */
+	CHECK(cached_id(cache, "a") == 1);
+	add(cache, "d", 4);
+	CHECK(cached_id(cache, "b") == -1);
+
+	/* d, a, c - c goes next */
+	add(cache, "e", 5);
+	CHECK(cached_id(cache, "c") == -1);
+	CHECK(cached_id(cache, "a") == 1);
+
+	/* a, e, d - d goes next */
+	add(cache, "f", 6);
+	CHECK(cached_id(cache, "d") == -1);
+	CHECK(cached_id(cache, "e") == 5);
+	CHECK(cached_id(cache, "f") == 6);
+	CHECK(cached_id(cache, "a") == 1);
+
+	const parse_cache_stats &stats = cache.get_stats();
+	CHECK(stats.inserts == 6);
+	CHECK(stats.evictions == 3);
+	CHECK(stats.hits == 5);
+	CHECK(stats.lookups == 8);
+	CHECK(stats.collisions == 0);
+}
+
+/**
+* @fn test_single_entry
+* @brief A cache of one line keeps the last one inserted.
+* @return None.
+*/
+static void test_single_entry() {
+	parse_cache cache(1);
+	add(cache, "a", 1);
+	CHECK(cached_id(cache, "a") == 1);
+
+	add(cache, "b", 2);
+	CHECK(cached_id(cache, "a") == -1);
+	CHECK(cached_id(cache, "b") == 2);
+}
+
+/**
+* @fn test_collision
+* @brief A line of a cached line's hash misses, and replaces the cached
+*		 line when inserted.
+* @return None.
+*/
+static void test_collision() {
+	parse_cache cache(4);
+	packet_record record;
+
+	cache.insert(std::string("x"), 7, record_of(1));
+	CHECK(!cache.find(std::string("y"), 7, record));
+	CHECK(cache.get_stats().collisions == 1);
+
+	cache.insert(std::string("y"), 7, record_of(2));
+	CHECK(!cache.find(std::string("x"), 7, record));
+	CHECK(cache.find(std::string("y"), 7, record));
+	CHECK(record.addr == 2);
+	CHECK(cache.get_stats().evictions == 0);
+}
+
+/**
+* @fn test_hash_line
+* @brief Equal lines hash equally wherever they are, and lines that
+*		 differ only in length or padding don't.
+* @return None.
+*/
+static void test_hash_line() {
+	const std::string line = "1|2|3|00 01 02 03 04 05 06 07 08 09 0a 0b";
+	const std::string copy = "  " + line;
+
+	CHECK(parse_cache::hash_line(line) ==
+		  parse_cache::hash_line(str_view(copy.data() + 2, line.size())));
+	CHECK(parse_cache::hash_line(std::string("a")) !=
+		  parse_cache::hash_line(std::string("a\0", 2)));
+	CHECK(parse_cache::hash_line(line) !=
+		  parse_cache::hash_line(line.substr(0, line.size() - 1)));
+}
+
+/**
+* @fn test_against_list
+* @brief Random lookups, inserting the lines that miss, against a list
+*		 kept in use order. The hashes are shifted so all lines probe
+*		 from the same bucket, and evictions move the probed buckets
+*		 back.
+* @param hash_shift - Bits the hash of a line is shifted left by.
+* @return None.
+*/
+static void test_against_list(int hash_shift) {
+	const size_t capacity = 8;
+	parse_cache cache(capacity);
+	std::list<int> used;
+	uint64_t state = 1;
+
+	for (int i = 0; i < TEST_LOOKUPS_NUM; i++) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		int id = (state >> 33) % TEST_LINES_NUM;
+		std::string line = "line " + std::to_string(id);
+		uint64_t hash = parse_cache::hash_line(line) << hash_shift;
+
+		std::list<int>::iterator it = std::find(used.begin(), used.end(), id);
+		bool expected = (it != used.end());
+		if (expected) {
+			used.erase(it);
+		} else if (used.size() == capacity) {
+			used.pop_back();
+		}
+		used.push_front(id);
+
+		packet_record record;
+		bool found = cache.find(line, hash, record);
+		CHECK(found == expected);
+		if (found) {
+			CHECK(record.addr == uint32_t(id));
+		} else {
+			cache.insert(line, hash, record_of(id));
+		}
+	}
+
+	CHECK(cache.get_stats().collisions == 0);
+}
+
+/**
+* @fn main
+* @brief Runs the tests of parse_cache.
+* @return 0 if they passed, 1 otherwise.
+*/
+int main() {
+	test_eviction_order();
+	test_single_entry();
+	test_collision();
+	test_hash_line();
+	test_against_list(0);
+	test_against_list(40);
+
+	return unit_test_result("parse_cache");
+}
@@ -0,0 +1,194 @@
+#include "queue_sink.h"
+#include <stdexcept>
+
+/**
+* @fn stream_sink
+* @brief Constructor of the class.
+* @param out - The stream to write to, must outlive the sink.
+* @return New sink object.
+*/
+stream_sink::stream_sink(std::ostream &out): out(out) {}
+
+/**
+* @fn push
+* @brief Writes the packet as a line to the stream.
+* @param packet - The packet as a string.
+* @return None.
+*/
+void stream_sink::push(const std::string &packet) {
+	this->out.write(packet.data(), packet.length());
+	this->out.put('\n');
+}
+
+/**
+* @fn flush
+* @brief Flushes the stream.
+* @return None.
+*/
+void stream_sink::flush() {
+	this->out.flush();
+}
+
+/**
+* @fn file_sink
+* @brief Constructor of the class, truncates the file.
+* @param file_name - Name of the file to write to.
+* @return New sink object.
+*/
+file_sink::file_sink(const std::string &file_name): file(file_name) {
+	if (!this->file.is_open()) {
+		throw std::invalid_argument("Could not open the file.");
+	}
+}
+
+/**
+* @fn push
+* @brief Writes the packet as a line to the file.
+* @param packet - The packet as a string.
+* @return None.
+*/
+void file_sink::push(const std::string &packet) {
+	this->file.write(packet.data(), packet.length());
+	this->file.put('\n');
+}
+
+/**
+* @fn flush
+* @brief Flushes the file.
+* @return None.
+*/
+void file_sink::flush() {
+	this->file.flush();
+}
+
+/**
+* @fn callback_sink
+* @brief Constructor of the class.
+* @param callback - Function to call with each packet.
+* @return New sink object.
+*/
+callback_sink::callback_sink(
+	std::function<void(const std::string&)> callback): callback(callback) {}
+
+/**
+* @fn push
+* @brief Calls the callback with the packet.
+* @param packet - The packet as a string.
+* @return None.
+*/
+void callback_sink::push(const std::string &packet) {
+	this->callback(packet);
+}
+
+/**
+* @fn bounded_sink
+* @brief Constructor of the class, starts the writer thread.
+* @param dest - The sink to pass packets to, must outlive this.
+* @param capacity - Max num of packets waiting in the queue.
+* @return New sink object.
+*/
+bounded_sink::bounded_sink(queue_sink &dest, size_t capacity):
+	dest(dest),
+	capacity(capacity > 0 ? capacity : 1),
+	stopping(false),
+	in_flight(0),
+	stalls(0) {
+
+	this->writer = std::thread(&bounded_sink::write_packets, this);
+}
+
+/**
+* @fn push
+* @brief Queues the packet for the writer, waits while the queue is full.
+* @param packet - The packet as a string.
+* @return None.
+*/
+void bounded_sink::push(const std::string &packet) {
+	std::unique_lock<std::mutex> guard(this->lock);
+
+	if (this->packets.size() >= this->capacity) {
+		this->stalls++;
+		this->not_full.wait(guard, [this] {
+			return this->packets.size() < this->capacity;
+		});
+	}
+
+	this->packets.push_back(packet);
+	this->not_empty.notify_one();
+}
+
+/**
+* @fn flush
+* @brief Waits until the writer passed all packets, then flushes
+*		 the destination.
+* @return None.
+*/
+void bounded_sink::flush() {
+	std::unique_lock<std::mutex> guard(this->lock);
+
+	this->not_full.wait(guard, [this] {
+		return this->packets.empty() && this->in_flight == 0;
+	});
+
+	this->dest.flush();
+}
+
+/**
+* @fn get_stalls
+* @brief Getter to the num of pushes that waited for a full queue.
+* @return The num of stalls.
+*/
+unsigned long bounded_sink::get_stalls() {
+	std::lock_guard<std::mutex> guard(this->lock);
+	return this->stalls;
+}
+
+/**
+* @fn ~bounded_sink
+* @brief Passes the remaining packets and stops the writer thread.
+* @return None.
+*/
+bounded_sink::~bounded_sink() {
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+
+	this->not_empty.notify_one();
+	this->writer.join();
+	this->dest.flush();
+}
+
+/**
+* @fn write_packets
+* @brief Body of the writer thread.
+* @return None.
+*/
+void bounded_sink::write_packets() {
+	std::unique_lock<std::mutex> guard(this->lock);
+
+	while (true) {
+		this->not_empty.wait(guard, [this] {
+			return !this->packets.empty() || this->stopping;
+		});
+
+		if (this->packets.empty()) {
+			return;
+		}
+
+		/* pass the packets to dest outside the lock */
+		std::deque<std::string> batch;
+		batch.swap(this->packets);
+		this->in_flight = batch.size();
+		this->not_full.notify_all();
+
+		guard.unlock();
+		for (const std::string &packet: batch) {
+			this->dest.push(packet);
+		}
+		guard.lock();
+
+		this->in_flight = 0;
+		this->not_full.notify_all();
+	}
+}
@@ -0,0 +1,156 @@
+#ifndef __QUEUE_SINK__
+#define __QUEUE_SINK__
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/* Default num of packets a bounded_sink holds before producers wait */
+const size_t DEFAULT_SINK_CAPACITY = 4096;
+
+/* Destination of the packets a NIC sends to RQ or TQ */
+class queue_sink {
+	public:
+
+		/**
+		* @fn push
+		* @brief Hands a packet to the sink.
+		* @param packet - The packet as a string.
+		* @return None.
+		*/
+		virtual void push(const std::string &packet) = 0;
+
+		/**
+		* @fn flush
+		* @brief Makes sure all pushed packets reached their destination.
+		* @return None.
+		*/
+		virtual void flush() {}
+
+		virtual ~queue_sink() {}
+};
+
+/* Writes each packet as a line to an output stream, e.g. std::cout */
+class stream_sink: public queue_sink {
+	std::ostream &out;
+
+	public:
+
+		/**
+		* @fn stream_sink
+		* @brief Constructor of the class.
+		* @param out - The stream to write to, must outlive the sink.
+		* @return New sink object.
+		*/
+		stream_sink(std::ostream &out);
+
+		void push(const std::string &packet);
+		void flush();
+};
+
+/* Writes each packet as a line to a file */
+class file_sink: public queue_sink {
+	std::ofstream file;
+
+	public:
+
+		/**
+		* @fn file_sink
+		* @brief Constructor of the class, truncates the file.
+		* @param file_name - Name of the file to write to.
+		* @return New sink object.
+		*/
+		file_sink(const std::string &file_name);
+
+		void push(const std::string &packet);
+		void flush();
+};
+
+/* Calls a function on each packet */
+class callback_sink: public queue_sink {
+	std::function<void(const std::string&)> callback;
+
+	public:
+
+		/**
+		* @fn callback_sink
+		* @brief Constructor of the class.
+		* @param callback - Function to call with each packet.
+		* @return New sink object.
+		*/
+		callback_sink(std::function<void(const std::string&)> callback);
+
+		void push(const std::string &packet);
+};
+
+/* Passes packets to another sink on a writer thread, through a queue of
+   bounded size. When the queue is full push waits (backpressure), so a
+   slow destination holds back the NIC instead of growing memory. */
+class bounded_sink: public queue_sink {
+	queue_sink &dest;
+	size_t capacity;
+
+	std::deque<std::string> packets;
+	std::mutex lock;
+	std::condition_variable not_full;
+	std::condition_variable not_empty;
+	bool stopping;
+	size_t in_flight;
+	unsigned long stalls;
+
+	std::thread writer;
+
+	public:
+
+		/**
+		* @fn bounded_sink
+		* @brief Constructor of the class, starts the writer thread.
+		* @param dest - The sink to pass packets to, must outlive this.
+		* @param capacity - Max num of packets waiting in the queue.
+		* @return New sink object.
+		*/
+		bounded_sink(queue_sink &dest,
+					 size_t capacity = DEFAULT_SINK_CAPACITY);
+
+		bounded_sink(const bounded_sink &other) = delete;
+		bounded_sink& operator=(const bounded_sink &other) = delete;
+
+		void push(const std::string &packet);
+
+		/**
+		* @fn flush
+		* @brief Waits until the writer passed all packets, then flushes
+		*		 the destination.
+		* @return None.
+		*/
+		void flush();
+
+		/**
+		* @fn get_stalls
+		* @brief Getter to the num of pushes that waited for a full queue.
+		* @return The num of stalls.
+		*/
+		unsigned long get_stalls();
+
+		/**
+		* @fn ~bounded_sink
+		* @brief Passes the remaining packets and stops the writer thread.
+		* @return None.
+		*/
+		~bounded_sink();
+
+	private:
+
+		/**
+		* @fn write_packets
+		* @brief Body of the writer thread.
+		* @return None.
+		*/
+		void write_packets();
+};
+#endif
@@ -0,0 +1,54 @@
+#include "nic_rack.h"
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+/**
+* @fn main
+* @brief Runs a packets file through several NICs at once, and writes
+*        the results of each NIC to "<param_file>.results".
+*        usage: rack_sim.exe [-j <threads>] <packets_file> <param_file>...
+*        The rack runs on as many threads as the hardware has, unless
+*        -j gives their num.
+* @return 0 upon success, 1 otherwise.
+*/
+int main(int argc, char* argv[]) {
+	int first_arg = 1;
+	unsigned int workers_num = std::thread::hardware_concurrency();
+
+	if (argc > 2 && std::string(argv[1]) == "-j") {
+		char* end;
+		unsigned long threads = strtoul(argv[2], &end, DEC_BASE);
+		if (*argv[2] == '\0' || *end != '\0' || threads > UINT_MAX) {
+			std::cerr << "Invalid num of threads." << std::endl;
+			return 1;
+		}
+		workers_num = threads;
+		first_arg = 3;
+	}
+
+	if (argc < first_arg + 2) {
+		std::cerr << "usage: " << argv[0]
+				  << " [-j <threads>] <packets_file> <param_file>..."
+				  << std::endl;
+		return 1;
+	}
+
+	std::vector<std::string> param_files(argv + first_arg + 1, argv + argc);
+
+	try {
+		nic_rack rack(param_files, workers_num);
+		rack.rack_flow(argv[first_arg]);
+
+		for (size_t nic = 0; nic < rack.size(); nic++) {
+			rack.get_nic(nic).nic_print_results(param_files[nic] +
+												".results");
+		}
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
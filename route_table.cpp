@@ -0,0 +1,144 @@
+#include "route_table.h"
+#include <algorithm>
+#include <stdexcept>
+
+/**
+* @fn route_table
+* @brief Constructor of the class. Tables are allocated by build.
+* @return New empty table, lookups find no route.
+*/
+route_table::route_table() {
+	this->routes_num = 0;
+}
+
+/**
+* @fn add
+* @brief Adds a route. A later route of the same prefix replaces
+*		 an earlier one.
+* @param prefix - Address of the route, see ipv4_subnet::ip_to_uint.
+*				  Bits past prefix_len are ignored.
+* @param prefix_len - Num of leading bits of the route, up to 32.
+* @param action - What to do with the route's packets.
+* @return None, throws std::invalid_argument if the prefix length
+*		  or action is invalid or the table was built.
+*/
+void route_table::add(uint32_t prefix, uint8_t prefix_len,
+					  route_action action) {
+	if (prefix_len > ROUTE_MAX_PREFIX_LEN) {
+		throw std::invalid_argument("Route prefix is too long.");
+	}
+
+	if (action == ROUTE_NONE) {
+		throw std::invalid_argument("Route has no action.");
+	}
+
+	if (!this->tbl24.empty()) {
+		throw std::invalid_argument("Route table was already built.");
+	}
+
+	route added = {prefix & prefix_mask(prefix_len), prefix_len, action};
+	this->routes.push_back(added);
+	this->routes_num++;
+}
+
+/**
+* @fn build
+* @brief Builds the lookup tables out of the added routes. Does
+*		 nothing if there are none.
+* @return None, throws std::invalid_argument if there are too
+*		  many groups of routes longer than 24 bits.
+*/
+void route_table::build() {
+	if (this->routes.empty()) {
+		return;
+	}
+
+	/* shorter routes are written first and longer ones over them, so
+	   each entry ends with its longest match. The sort is stable, so of
+	   the same prefix the later route is written last. */
+	std::stable_sort(this->routes.begin(), this->routes.end(),
+					 [](const route &a, const route &b) {
+						 return a.prefix_len < b.prefix_len;
+					 });
+
+	this->tbl24.assign(size_t(1) << ROUTE_TBL24_BITS, ROUTE_NONE);
+	int tbl8_bits = ROUTE_MAX_PREFIX_LEN - ROUTE_TBL24_BITS;
+
+	for (const route &added: this->routes) {
+		size_t first = added.prefix >> tbl8_bits;
+
+		if (added.prefix_len <= ROUTE_TBL24_BITS) {
+			size_t count = size_t(1) << (ROUTE_TBL24_BITS - added.prefix_len);
+			std::fill_n(this->tbl24.begin() + first, count, added.action);
+			continue;
+		}
+
+		/* a group starts with the action of the shorter routes over it */
+		uint16_t entry = this->tbl24[first];
+		if (!(entry & ROUTE_TBL8_FLAG)) {
+			size_t groups_num = this->tbl8.size() / ROUTE_TBL8_SIZE;
+			if (groups_num == ROUTE_MAX_TBL8_GROUPS) {
+				throw std::invalid_argument("Too many routes longer than 24 "
+											"bits.");
+			}
+
+			this->tbl8.resize(this->tbl8.size() + ROUTE_TBL8_SIZE, entry);
+			entry = ROUTE_TBL8_FLAG | groups_num;
+			this->tbl24[first] = entry;
+		}
+
+		size_t group = entry & ~ROUTE_TBL8_FLAG;
+		size_t count = size_t(1) << (ROUTE_MAX_PREFIX_LEN - added.prefix_len);
+		std::fill_n(this->tbl8.begin() + group * ROUTE_TBL8_SIZE +
+					(added.prefix & 0xff),
+					count,
+					added.action);
+	}
+
+	/* the added routes aren't needed once they are in the tables */
+	std::vector<route>().swap(this->routes);
+}
+
+/**
+* @fn size
+* @brief Getter to the num of routes added.
+* @return The num of routes.
+*/
+size_t route_table::size() const {
+	return this->routes_num;
+}
+
+/**
+* @fn prefix_mask
+* @brief Getter to the mask of a prefix length.
+* @param prefix_len - Num of leading bits, up to 32.
+* @return The mask, its prefix_len leading bits set.
+*/
+uint32_t route_table::prefix_mask(uint8_t prefix_len) {
+	/* a shift by 32 is undefined, /0 covers all addresses */
+	return (prefix_len == 0 ? 0 :
+			UINT32_MAX << (ROUTE_MAX_PREFIX_LEN - prefix_len));
+}
+
+/**
+* @fn parse_action
+* @brief Converts the name of an action in a param file ("rq",
+*		 "tq" or "drop") to the action.
+* @param name - The name.
+* @return The action, throws std::invalid_argument if unknown.
+*/
+route_action route_table::parse_action(const std::string &name) {
+	if (name == "rq") {
+		return ROUTE_RQ;
+	}
+
+	if (name == "tq") {
+		return ROUTE_TQ;
+	}
+
+	if (name == "drop") {
+		return ROUTE_DROP;
+	}
+
+	throw std::invalid_argument("Unknown route action.");
+}
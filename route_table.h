@@ -0,0 +1,123 @@
+#ifndef __ROUTE_TABLE__
+#define __ROUTE_TABLE__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Max length of an IPv4 prefix */
+const int ROUTE_MAX_PREFIX_LEN = 32;
+/* Num of top address bits indexing the first level of a route table */
+const int ROUTE_TBL24_BITS = 24;
+/* Num of entries in a second level group, one per last address byte */
+const int ROUTE_TBL8_SIZE = 256;
+/* Max num of second level groups, for routes longer than 24 bits */
+const size_t ROUTE_MAX_TBL8_GROUPS = 1 << 15;
+/* Set in a first level entry that holds the index of a group */
+const uint16_t ROUTE_TBL8_FLAG = 0x8000;
+
+/* What a NIC does with an L3 packet by its dst IP */
+enum route_action {
+    ROUTE_NONE,
+    ROUTE_RQ,
+    ROUTE_TQ,
+    ROUTE_DROP
+};
+
+/* Longest prefix match table of IPv4 routes, DIR-24-8 style: the top 24
+   bits of an address index a table of 2^24 entries, each holding the
+   action of the longest route covering it or, if a route longer than 24
+   bits starts there, the index of a 256 entry group for the last byte.
+   A lookup is one or two reads. Routes are added, then built once. */
+class route_table {
+	/* a route as added, kept until the table is built */
+	struct route {
+		uint32_t prefix;
+		uint8_t prefix_len;
+		route_action action;
+	};
+
+	std::vector<route> routes;
+	/* entries are an action, or ROUTE_TBL8_FLAG and the index of a group */
+	std::vector<uint16_t> tbl24;
+	std::vector<uint16_t> tbl8;
+	size_t routes_num;
+
+	public:
+
+		/**
+		* @fn route_table
+		* @brief Constructor of the class. Tables are allocated by build.
+		* @return New empty table, lookups find no route.
+		*/
+		route_table();
+
+		/**
+		* @fn add
+		* @brief Adds a route. A later route of the same prefix replaces
+		*		 an earlier one.
+		* @param prefix - Address of the route, see ipv4_subnet::ip_to_uint.
+		*				  Bits past prefix_len are ignored.
+		* @param prefix_len - Num of leading bits of the route, up to 32.
+		* @param action - What to do with the route's packets.
+		* @return None, throws std::invalid_argument if the prefix length
+		*		  or action is invalid or the table was built.
+		*/
+		void add(uint32_t prefix, uint8_t prefix_len, route_action action);
+
+		/**
+		* @fn build
+		* @brief Builds the lookup tables out of the added routes. Does
+		*		 nothing if there are none.
+		* @return None, throws std::invalid_argument if there are too
+		*		  many groups of routes longer than 24 bits.
+		*/
+		void build();
+
+		/**
+		* @fn lookup
+		* @brief Finds the action of the longest route matching an address.
+		* @param ip - The address, see ipv4_subnet::ip_to_uint.
+		* @return The action, ROUTE_NONE if no route matches or the table
+		*		  isn't built.
+		*/
+		route_action lookup(uint32_t ip) const {
+			if (this->tbl24.empty()) {
+				return ROUTE_NONE;
+			}
+
+			uint16_t entry = this->tbl24[ip >> (32 - ROUTE_TBL24_BITS)];
+			if (entry & ROUTE_TBL8_FLAG) {
+				size_t group = entry & ~ROUTE_TBL8_FLAG;
+				entry = this->tbl8[group * ROUTE_TBL8_SIZE + (ip & 0xff)];
+			}
+
+			return static_cast<route_action>(entry);
+		}
+
+		/**
+		* @fn size
+		* @brief Getter to the num of routes added.
+		* @return The num of routes.
+		*/
+		size_t size() const;
+
+		/**
+		* @fn prefix_mask
+		* @brief Getter to the mask of a prefix length.
+		* @param prefix_len - Num of leading bits, up to 32.
+		* @return The mask, its prefix_len leading bits set.
+		*/
+		static uint32_t prefix_mask(uint8_t prefix_len);
+
+		/**
+		* @fn parse_action
+		* @brief Converts the name of an action in a param file ("rq",
+		*		 "tq" or "drop") to the action.
+		* @param name - The name.
+		* @return The action, throws std::invalid_argument if unknown.
+		*/
+		static route_action parse_action(const std::string &name);
+};
+#endif
@@ -0,0 +1,219 @@
+#include "route_table.h"
+#include "unit_test.h"
+#include <stdexcept>
+#include <vector>
+
+/* Num of random routes of the longest prefix match test */
+const int TEST_ROUTES_NUM = 2000;
+/* Num of random addresses looked up in it */
+const int TEST_LOOKUPS_NUM = 20000;
+
+/**
+* @fn ip
+* @brief Packs an IPv4 address, see ipv4_subnet::ip_to_uint.
+* @return The address.
+*/
+static uint32_t ip(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+	return (a << 24) | (b << 16) | (c << 8) | d;
+}
+
+/**
+* @fn next_random
+* @brief Steps a random state.
+* @param state[out] - The state.
+* @return 32 random bits.
+*/
+static uint32_t next_random(uint64_t &state) {
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return state >> 32;
+}
+
+/**
+* @fn test_empty
+* @brief Lookups of a table without routes find none.
+* @return None.
+*/
+static void test_empty() {
+	route_table routes;
+	CHECK(routes.lookup(ip(10, 0, 0, 1)) == ROUTE_NONE);
+
+	routes.build();
+	CHECK(routes.lookup(ip(10, 0, 0, 1)) == ROUTE_NONE);
+	CHECK(routes.size() == 0);
+}
+
+/**
+* @fn test_overlaps
+* @brief Routes of /0, /24, /25 and /32 over the same addresses, added
+*		 longest first so the build has to order them.
+* @return None.
+*/
+static void test_overlaps() {
+	route_table routes;
+	routes.add(ip(10, 1, 2, 5), 32, ROUTE_DROP);
+	routes.add(ip(10, 1, 2, 200), 32, ROUTE_TQ);
+	routes.add(ip(10, 1, 2, 128), 25, ROUTE_DROP);
+	routes.add(ip(10, 1, 2, 0), 24, ROUTE_RQ);
+	routes.add(0, 0, ROUTE_TQ);
+	routes.build();
+
+	CHECK(routes.size() == 5);
+	CHECK(routes.lookup(ip(9, 255, 255, 255)) == ROUTE_TQ);
+	CHECK(routes.lookup(ip(10, 1, 1, 255)) == ROUTE_TQ);
+	CHECK(routes.lookup(ip(10, 1, 2, 0)) == ROUTE_RQ);
+	CHECK(routes.lookup(ip(10, 1, 2, 4)) == ROUTE_RQ);
+	CHECK(routes.lookup(ip(10, 1, 2, 5)) == ROUTE_DROP);
+	CHECK(routes.lookup(ip(10, 1, 2, 6)) == ROUTE_RQ);
+	CHECK(routes.lookup(ip(10, 1, 2, 127)) == ROUTE_RQ);
+	CHECK(routes.lookup(ip(10, 1, 2, 128)) == ROUTE_DROP);
+	CHECK(routes.lookup(ip(10, 1, 2, 199)) == ROUTE_DROP);
+	CHECK(routes.lookup(ip(10, 1, 2, 200)) == ROUTE_TQ);
+	CHECK(routes.lookup(ip(10, 1, 2, 255)) == ROUTE_DROP);
+	CHECK(routes.lookup(ip(10, 1, 3, 0)) == ROUTE_TQ);
+	CHECK(routes.lookup(UINT32_MAX) == ROUTE_TQ);
+}
+
+/**
+* @fn test_second_level_only
+* @brief A /32 with no shorter route over it, the rest of its group
+*		 finds no route.
+* @return None.
+*/
+static void test_second_level_only() {
+	route_table routes;
+	routes.add(ip(192, 168, 0, 1), 32, ROUTE_RQ);
+	routes.build();
+
+	CHECK(routes.lookup(ip(192, 168, 0, 1)) == ROUTE_RQ);
+	CHECK(routes.lookup(ip(192, 168, 0, 0)) == ROUTE_NONE);
+	CHECK(routes.lookup(ip(192, 168, 0, 2)) == ROUTE_NONE);
+	CHECK(routes.lookup(ip(192, 168, 1, 1)) == ROUTE_NONE);
+}
+
+/**
+* @fn test_replace_and_host_bits
+* @brief A later route of the same prefix replaces an earlier one, and
+*		 bits past the prefix length are masked.
+* @return None.
+*/
+static void test_replace_and_host_bits() {
+	route_table routes;
+	routes.add(ip(10, 0, 0, 0), 8, ROUTE_RQ);
+	routes.add(ip(10, 9, 9, 9), 8, ROUTE_DROP);
+	routes.add(ip(172, 16, 5, 77), 25, ROUTE_TQ);
+	routes.build();
+
+	CHECK(routes.lookup(ip(10, 200, 0, 1)) == ROUTE_DROP);
+	CHECK(routes.lookup(ip(172, 16, 5, 0)) == ROUTE_TQ);
+	CHECK(routes.lookup(ip(172, 16, 5, 127)) == ROUTE_TQ);
+	CHECK(routes.lookup(ip(172, 16, 5, 128)) == ROUTE_NONE);
+}
+
+/**
+* @fn test_invalid
+* @brief Invalid routes and adds after the build throw.
+* @return None.
+*/
+static void test_invalid() {
+	route_table routes;
+	bool thrown = false;
+	try {
+		routes.add(0, 33, ROUTE_RQ);
+	} catch (const std::invalid_argument &e) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	thrown = false;
+	try {
+		routes.add(0, 8, ROUTE_NONE);
+	} catch (const std::invalid_argument &e) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	routes.add(0, 8, ROUTE_RQ);
+	routes.build();
+
+	thrown = false;
+	try {
+		routes.add(ip(1, 0, 0, 0), 8, ROUTE_RQ);
+	} catch (const std::invalid_argument &e) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	CHECK(route_table::prefix_mask(0) == 0);
+	CHECK(route_table::prefix_mask(25) == 0xffffff80);
+	CHECK(route_table::prefix_mask(32) == UINT32_MAX);
+	CHECK(route_table::parse_action("drop") == ROUTE_DROP);
+}
+
+/**
+* @fn test_random_against_linear
+* @brief Lookups of random routes, most of them 16 to 32 bits long,
+*		 against a linear search for the longest match.
+* @return None.
+*/
+static void test_random_against_linear() {
+	struct test_route {
+		uint32_t prefix;
+		uint8_t prefix_len;
+		route_action action;
+	};
+
+	std::vector<test_route> added;
+	route_table routes;
+	uint64_t state = 1;
+
+	for (int i = 0; i < TEST_ROUTES_NUM; i++) {
+		uint32_t bits = next_random(state);
+		uint8_t prefix_len = (i % 100 == 0 ? bits % 16 : 16 + bits % 17);
+		/* keep the routes in a few /8s, so they overlap */
+		uint32_t prefix = next_random(state) & 0x03ffffff &
+						  route_table::prefix_mask(prefix_len);
+		route_action action = static_cast<route_action>(ROUTE_RQ + bits % 3);
+
+		routes.add(prefix, prefix_len, action);
+		added.push_back({prefix, prefix_len, action});
+	}
+	routes.build();
+
+	for (int i = 0; i < TEST_LOOKUPS_NUM; i++) {
+		uint32_t addr = next_random(state) & 0x03ffffff;
+		if (i % 2 == 0) {
+			/* half the lookups land next to a route */
+			const test_route &near = added[i % added.size()];
+			addr = near.prefix | (addr & 0xff);
+		}
+
+		route_action expected = ROUTE_NONE;
+		int best_len = -1;
+		for (const test_route &r: added) {
+			uint32_t mask = route_table::prefix_mask(r.prefix_len);
+			/* the later of equal prefixes wins, as in the table */
+			if ((addr & mask) == r.prefix && r.prefix_len >= best_len) {
+				best_len = r.prefix_len;
+				expected = r.action;
+			}
+		}
+
+		CHECK(routes.lookup(addr) == expected);
+	}
+}
+
+/**
+* @fn main
+* @brief Runs the tests of route_table.
+* @return 0 if they passed, 1 otherwise.
+*/
+int main() {
+	test_empty();
+	test_overlaps();
+	test_second_level_only();
+	test_replace_and_host_bits();
+	test_invalid();
+	test_random_against_linear();
+
+	return unit_test_result("route_table");
+}
@@ -0,0 +1,136 @@
+#ifndef __SPSC_RING__
+#define __SPSC_RING__
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/* Size of a cache line, counters of the two sides are kept this far apart */
+const size_t CACHE_LINE_SIZE = 64;
+
+/* Bounded lock free queue between exactly one producer thread and one
+   consumer thread. The producer may close it once it is done, so the
+   consumer can tell an empty queue from a finished one. */
+template <class T>
+class spsc_ring {
+	std::vector<T> slots;
+	size_t mask;
+
+	/* next slot to pop, written by the consumer only */
+	char head_pad[CACHE_LINE_SIZE];
+	std::atomic<size_t> head;
+	/* next slot to push, written by the producer only */
+	char tail_pad[CACHE_LINE_SIZE];
+	std::atomic<size_t> tail;
+	char closed_pad[CACHE_LINE_SIZE];
+	std::atomic<bool> closed;
+
+	public:
+
+		/**
+		* @fn spsc_ring
+		* @brief Constructor of the class.
+		* @param capacity - Min num of items the queue holds, rounded up
+		*		 to a power of 2.
+		* @return New empty queue.
+		*/
+		explicit spsc_ring(size_t capacity): head(0), tail(0), closed(false) {
+			size_t size = 1;
+			while (size < capacity) {
+				size <<= 1;
+			}
+
+			this->slots.resize(size);
+			this->mask = size - 1;
+		}
+
+		spsc_ring(const spsc_ring &other) = delete;
+		spsc_ring& operator=(const spsc_ring &other) = delete;
+
+		/**
+		* @fn try_push
+		* @brief Adds an item if there is room, producer only.
+		* @param item - The item.
+		* @return True if it was added, false if the queue is full.
+		*/
+		bool try_push(const T &item) {
+			size_t tail = this->tail.load(std::memory_order_relaxed);
+			if (tail - this->head.load(std::memory_order_acquire) >
+				this->mask) {
+				return false;
+			}
+
+			this->slots[tail & this->mask] = item;
+			this->tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		* @fn try_pop
+		* @brief Takes the oldest item if there is one, consumer only.
+		* @param item[out] - The item.
+		* @return True if an item was taken, false if the queue is empty.
+		*/
+		bool try_pop(T &item) {
+			size_t head = this->head.load(std::memory_order_relaxed);
+			if (head == this->tail.load(std::memory_order_acquire)) {
+				return false;
+			}
+
+			item = this->slots[head & this->mask];
+			this->head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		* @fn push
+		* @brief Adds an item, waiting for room, producer only.
+		* @param item - The item.
+		* @param stop - Flag that ends the wait, e.g. when a stage failed.
+		* @return True if it was added, false if stop was raised.
+		*/
+		bool push(const T &item, const std::atomic<bool> &stop) {
+			while (!this->try_push(item)) {
+				if (stop.load(std::memory_order_relaxed)) {
+					return false;
+				}
+				std::this_thread::yield();
+			}
+
+			return true;
+		}
+
+		/**
+		* @fn pop
+		* @brief Takes the oldest item, waiting for one, consumer only.
+		* @param item[out] - The item.
+		* @param stop - Flag that ends the wait, e.g. when a stage failed.
+		* @return True if an item was taken, false if the queue is closed
+		*		  and empty, or stop was raised.
+		*/
+		bool pop(T &item, const std::atomic<bool> &stop) {
+			while (!this->try_pop(item)) {
+				if (this->closed.load(std::memory_order_acquire)) {
+					/* items pushed before closing are visible now */
+					return this->try_pop(item);
+				}
+				if (stop.load(std::memory_order_relaxed)) {
+					return false;
+				}
+				std::this_thread::yield();
+			}
+
+			return true;
+		}
+
+		/**
+		* @fn close
+		* @brief Marks that no more items will be pushed, producer only.
+		* @return None.
+		*/
+		void close() {
+			this->closed.store(true, std::memory_order_release);
+		}
+};
+#endif
@@ -0,0 +1,129 @@
+#include "spsc_ring.h"
+#include "unit_test.h"
+#include <thread>
+
+/* Num of items passed between the threads of the threaded test */
+const size_t TEST_ITEMS_NUM = 200000;
+
+/**
+* @fn test_full_and_empty
+* @brief Fills a queue, its capacity rounded up to 8, and empties it.
+* @return None.
+*/
+static void test_full_and_empty() {
+	spsc_ring<int> ring(5);
+	int item = -1;
+
+	CHECK(!ring.try_pop(item));
+	CHECK(item == -1);
+
+	for (int i = 0; i < 8; i++) {
+		CHECK(ring.try_push(i));
+	}
+	CHECK(!ring.try_push(8));
+
+	for (int i = 0; i < 8; i++) {
+		CHECK(ring.try_pop(item));
+		CHECK(item == i);
+	}
+	CHECK(!ring.try_pop(item));
+	CHECK(ring.try_push(8));
+}
+
+/**
+* @fn test_wrap_around
+* @brief Pushes and pops 3 items at a time through 4 slots, so the
+*		 positions go around the slots many times.
+* @return None.
+*/
+static void test_wrap_around() {
+	spsc_ring<int> ring(4);
+	int next_push = 0;
+	int next_pop = 0;
+
+	for (int round = 0; round < 1000; round++) {
+		for (int i = 0; i < 3; i++) {
+			CHECK(ring.try_push(next_push++));
+		}
+
+		for (int i = 0; i < 3; i++) {
+			int item;
+			CHECK(ring.try_pop(item));
+			CHECK(item == next_pop++);
+		}
+	}
+
+	int item;
+	CHECK(!ring.try_pop(item));
+}
+
+/**
+* @fn test_close
+* @brief Items pushed before closing are popped, then pop ends. A raised
+*		 stop flag ends the waits of an empty and a full queue.
+* @return None.
+*/
+static void test_close() {
+	std::atomic<bool> stop(false);
+	spsc_ring<int> ring(2);
+	int item;
+
+	CHECK(ring.push(1, stop));
+	CHECK(ring.push(2, stop));
+	ring.close();
+
+	CHECK(ring.pop(item, stop) && item == 1);
+	CHECK(ring.pop(item, stop) && item == 2);
+	CHECK(!ring.pop(item, stop));
+
+	spsc_ring<int> stopped(2);
+	stop.store(true);
+	CHECK(!stopped.pop(item, stop));
+	CHECK(stopped.push(1, stop));
+	CHECK(stopped.push(2, stop));
+	CHECK(!stopped.push(3, stop));
+}
+
+/**
+* @fn test_threads
+* @brief Passes items from a producer thread to a consumer thread
+*		 through a small queue, which is full and empty many times.
+* @return None.
+*/
+static void test_threads() {
+	std::atomic<bool> stop(false);
+	spsc_ring<size_t> ring(16);
+
+	std::thread producer([&]() {
+		for (size_t i = 0; i < TEST_ITEMS_NUM; i++) {
+			ring.push(i, stop);
+		}
+		ring.close();
+	});
+
+	size_t expected = 0;
+	size_t out_of_order = 0;
+	size_t item;
+	while (ring.pop(item, stop)) {
+		out_of_order += (item != expected);
+		expected++;
+	}
+	producer.join();
+
+	CHECK(expected == TEST_ITEMS_NUM);
+	CHECK(out_of_order == 0);
+}
+
+/**
+* @fn main
+* @brief Runs the tests of spsc_ring.
+* @return 0 if they passed, 1 otherwise.
+*/
+int main() {
+	test_full_and_empty();
+	test_wrap_around();
+	test_close();
+	test_threads();
+
+	return unit_test_result("spsc_ring");
+}
@@ -0,0 +1,79 @@
+#include "tokenizer.h"
+#include <climits>
+
+/**
+* @fn packet_tokenizer
+* @brief Splits a packet line into its '|' separated fields,
+*		 finding every delimiter in a single pass.
+*		 Delimiters after the last possible field are kept in it.
+* @param line - The packet line, must outlive the tokenizer.
+* @return New tokenizer object.
+*/
+packet_tokenizer::packet_tokenizer(str_view line) {
+	this->fields_num = 0;
+
+	size_t start = 0;
+	for (size_t i = 0; i < line.len; i++) {
+		if (line.ptr[i] != FIELD_DELIMITER ||
+			this->fields_num == MAX_PACKET_FIELDS - 1) {
+			continue;
+		}
+
+		this->fields[this->fields_num++] = str_view(line.ptr + start,
+													i - start);
+		start = i + 1;
+	}
+
+	this->fields[this->fields_num++] = str_view(line.ptr + start,
+												line.len - start);
+}
+
+/**
+* @fn size
+* @brief Getter to the number of fields found.
+* @return The number of fields.
+*/
+int packet_tokenizer::size() const {
+	return this->fields_num;
+}
+
+/**
+* @fn get_fields
+* @brief Getter to the fields found, in order.
+* @return Pointer to the first field.
+*/
+const str_view* packet_tokenizer::get_fields() const {
+	return this->fields;
+}
+
+/**
+* @fn to_uint
+* @brief Converts the leading decimal digits of a field to a number.
+* @param field - The field to convert.
+* @param num[out] - The number, set only upon success.
+* @return True upon success, false if the field doesn't start with
+*		  a digit or the number is larger than UINT_MAX.
+*/
+bool packet_tokenizer::to_uint(str_view field, unsigned int &num) {
+	unsigned long long value = 0;
+	size_t i = 0;
+
+	for (; i < field.len; i++) {
+		char c = field.ptr[i];
+		if (c < '0' || c > '9') {
+			break;
+		}
+
+		value = value * 10 + (c - '0');
+		if (value > UINT_MAX) {
+			return false;
+		}
+	}
+
+	if (i == 0) {
+		return false;
+	}
+
+	num = value;
+	return true;
+}
@@ -0,0 +1,67 @@
+#ifndef __TOKENIZER__
+#define __TOKENIZER__
+
+#include <cstddef>
+#include <string>
+
+/* Max num of '|' separated fields in a packet (L2 packet has the most) */
+const int MAX_PACKET_FIELDS = 11;
+/* Delimiter between the fields of a packet */
+const char FIELD_DELIMITER = '|';
+
+/* A non owning view of a range of chars */
+struct str_view {
+	const char* ptr;
+	size_t len;
+
+	/**
+	* @fn str_view
+	* @brief Constructors of the struct. The viewed chars must outlive it.
+	* @return New view.
+	*/
+	str_view(): ptr(nullptr), len(0) {}
+	str_view(const char* ptr, size_t len): ptr(ptr), len(len) {}
+	str_view(const std::string &str): ptr(str.data()), len(str.length()) {}
+};
+
+class packet_tokenizer {
+	str_view fields[MAX_PACKET_FIELDS];
+	int fields_num;
+
+	public:
+
+		/**
+		* @fn packet_tokenizer
+		* @brief Splits a packet line into its '|' separated fields,
+		*		 finding every delimiter in a single pass.
+		*		 Delimiters after the last possible field are kept in it.
+		* @param line - The packet line, must outlive the tokenizer.
+		* @return New tokenizer object.
+		*/
+		packet_tokenizer(str_view line);
+
+		/**
+		* @fn size
+		* @brief Getter to the number of fields found.
+		* @return The number of fields.
+		*/
+		int size() const;
+
+		/**
+		* @fn get_fields
+		* @brief Getter to the fields found, in order.
+		* @return Pointer to the first field.
+		*/
+		const str_view* get_fields() const;
+
+		/**
+		* @fn to_uint
+		* @brief Converts the leading decimal digits of a field to a number.
+		* @param field - The field to convert.
+		* @param num[out] - The number, set only upon success.
+		* @return True upon success, false if the field doesn't start with
+		*		  a digit or the number is larger than UINT_MAX.
+		*/
+		static bool to_uint(str_view field, unsigned int &num);
+};
+#endif
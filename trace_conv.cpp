@@ -0,0 +1,28 @@
+#include "NIC_sim.hpp"
+#include <iostream>
+
+/**
+* @fn main
+* @brief Converts a text packets file to a binary trace for
+*        nic_sim::nic_flow_binary.
+*        usage: trace_conv.exe <packets_file> <trace_file>
+* @return 0 upon success, 1 otherwise.
+*/
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		std::cerr << "usage: " << argv[0] << " <packets_file> <trace_file>"
+				  << std::endl;
+		return 1;
+	}
+
+	try {
+		unsigned long packets_num = nic_sim::convert_trace(argv[1], argv[2]);
+		std::cout << packets_num << " packets written to " << argv[2]
+				  << std::endl;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
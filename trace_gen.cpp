@@ -0,0 +1,333 @@
+#include "trace_gen.h"
+#include "fd_writer.h"
+#include "packet_record.h"
+
+/* TTLs of L3 packets, mostly valid ones, 0 fails validation */
+static const unsigned int TRACE_TTLS[] = {0, 1, 2, 64, 64, 64, 128, 255};
+/* Num of entries in TRACE_TTLS */
+static const int TRACE_TTLS_NUM = sizeof(TRACE_TTLS) / sizeof(TRACE_TTLS[0]);
+/* Max num of a port */
+static const uint32_t MAX_PORT = 65535;
+/* Num of last packet lines a repeated packet is drawn from */
+static const size_t TRACE_REPEAT_WINDOW = 256;
+/* Any non zero state works for xorshift, this one replaces a 0 seed */
+static const uint64_t ZERO_SEED_STATE = 0x9e3779b97f4a7c15ULL;
+
+/**
+* @fn trace_gen
+* @brief Constructor of the class, draws the NIC's parameters.
+* @param config - Shape of the traffic.
+* @return New generator object.
+*/
+trace_gen::trace_gen(const trace_config &config): config(config),
+												   recent_next(0) {
+	this->state = (config.seed != 0 ? config.seed : ZERO_SEED_STATE);
+
+	for (int i = 0; i < MAC_SIZE; i++) {
+		this->nic_mac[i] = this->below(256);
+	}
+
+	for (int i = 0; i < IP_V4_SIZE; i++) {
+		this->nic_ip[i] = this->below(256);
+	}
+
+	for (int i = 0; i < config.ports_num; i++) {
+		this->src_ports.push_back(1 + this->below(MAX_PORT));
+		this->dst_ports.push_back(1 + this->below(MAX_PORT));
+	}
+}
+
+/**
+* @fn write_params
+* @brief Appends the NIC's parameters file: MAC, "ip/mask" and a
+*		 "src:<port>,dst:<port>" line per open port.
+* @param out[out] - The buffer to append the file to.
+* @return None.
+*/
+void trace_gen::write_params(out_buffer &out) const {
+	write_mac(this->nic_mac, out);
+	out.append('\n');
+
+	write_ip(this->nic_ip, out);
+	out.append('/');
+	out.append_uint(this->config.mask_len);
+	out.append('\n');
+
+	for (size_t i = 0; i < this->src_ports.size(); i++) {
+		out.append("src:", 4);
+		out.append_uint(this->src_ports[i]);
+		out.append(",dst:", 5);
+		out.append_uint(this->dst_ports[i]);
+		out.append('\n');
+	}
+}
+
+/**
+* @fn next_line
+* @brief Appends the next packet line, followed by '\n'. With
+*		 repeat_ratio it may be a copy of a recent line.
+* @param out[out] - The buffer to append the line to.
+* @return None.
+*/
+void trace_gen::next_line(out_buffer &out) {
+	/* nothing is drawn for repeats unless asked, so traces of a seed
+	   stay the same */
+	if (this->config.repeat_ratio <= 0) {
+		this->new_line(out);
+		return;
+	}
+
+	if (!this->recent.empty() && this->chance(this->config.repeat_ratio)) {
+		const std::string &line = this->recent[this->below(
+			this->recent.size())];
+		out.append(line.data(), line.size());
+		return;
+	}
+
+	size_t start = out.size();
+	this->new_line(out);
+
+	std::string line(out.data() + start, out.size() - start);
+	if (this->recent.size() < TRACE_REPEAT_WINDOW) {
+		this->recent.push_back(line);
+	} else {
+		this->recent[this->recent_next] = line;
+		this->recent_next = (this->recent_next + 1) % TRACE_REPEAT_WINDOW;
+	}
+}
+
+/**
+* @fn new_line
+* @brief Appends a packet line drawn from scratch, followed by '\n'.
+* @param out[out] - The buffer to append the line to.
+* @return None.
+*/
+void trace_gen::new_line(out_buffer &out) {
+	unsigned int src_port;
+	unsigned int dst_port;
+
+	if (!this->src_ports.empty() && this->chance(this->config.open_port_ratio)) {
+		uint32_t port = this->below(this->src_ports.size());
+		src_port = this->src_ports[port];
+		dst_port = this->dst_ports[port];
+	} else {
+		src_port = 1 + this->below(MAX_PORT);
+		dst_port = 1 + this->below(MAX_PORT);
+	}
+
+	unsigned int addr = this->below(DATA_ARR_SIZE - DATA_L5_SIZE + 1);
+	uint8_t data[DATA_L5_SIZE];
+	unsigned int sum = sum_bytes(src_port) + sum_bytes(dst_port) +
+					   sum_bytes(addr);
+	for (int i = 0; i < DATA_L5_SIZE; i++) {
+		data[i] = this->below(256);
+		sum += data[i];
+	}
+
+	double layer = this->unit();
+	bool is_l2 = (layer < this->config.l2_ratio);
+	bool is_l3 = (!is_l2 && layer < this->config.l2_ratio +
+									 this->config.l3_ratio);
+
+	uint8_t src_mac[MAC_SIZE];
+	uint8_t dst_mac[MAC_SIZE];
+	if (is_l2) {
+		bool to_nic = this->chance(this->config.nic_mac_ratio);
+		for (int i = 0; i < MAC_SIZE; i++) {
+			src_mac[i] = this->below(256);
+			dst_mac[i] = (to_nic ? this->nic_mac[i] : this->below(256));
+		}
+
+		write_mac(src_mac, out);
+		out.append('|');
+		write_mac(dst_mac, out);
+		out.append('|');
+	}
+
+	unsigned int L3_cs = 0;
+	if (is_l2 || is_l3) {
+		uint8_t src_ip[IP_V4_SIZE];
+		uint8_t dst_ip[IP_V4_SIZE];
+		this->random_ip(src_ip);
+		this->random_ip(dst_ip);
+		unsigned int ttl = TRACE_TTLS[this->below(TRACE_TTLS_NUM)];
+
+		for (int i = 0; i < IP_V4_SIZE; i++) {
+			sum += src_ip[i] + dst_ip[i];
+		}
+		sum += sum_bytes(ttl);
+		L3_cs = sum + (this->chance(this->config.bad_cs_ratio) ? 1 : 0);
+
+		write_ip(src_ip, out);
+		out.append('|');
+		write_ip(dst_ip, out);
+		out.append('|');
+		out.append_uint(ttl);
+		out.append('|');
+		out.append_uint(L3_cs);
+		out.append('|');
+	}
+
+	out.append_uint(src_port);
+	out.append('|');
+	out.append_uint(dst_port);
+	out.append('|');
+	out.append_uint(addr);
+	out.append('|');
+	out.append_hex(data, DATA_L5_SIZE);
+
+	if (is_l2) {
+		for (int i = 0; i < MAC_SIZE; i++) {
+			sum += src_mac[i] + dst_mac[i];
+		}
+		sum += sum_bytes(L3_cs);
+
+		out.append('|');
+		out.append_uint(sum + (this->chance(this->config.bad_cs_ratio) ?
+							   1 : 0));
+	}
+
+	out.append('\n');
+}
+
+/**
+* @fn write_files
+* @brief Writes the parameters file and packets_num packet lines.
+* @param param_file - Name of the parameters file to create.
+* @param packet_file - Name of the packets file to create.
+* @return None, throws std::invalid_argument if a file can't be
+*		  written.
+*/
+void trace_gen::write_files(const std::string &param_file,
+							const std::string &packet_file) {
+	fd_writer params(param_file);
+	this->write_params(params.buffer());
+	params.flush();
+
+	fd_writer packets(packet_file);
+	for (unsigned long i = 0; i < this->config.packets_num; i++) {
+		this->next_line(packets.buffer());
+	}
+	packets.flush();
+}
+
+/**
+* @fn next
+* @brief Draws the next 64 random bits (xorshift64*).
+* @return The random bits.
+*/
+uint64_t trace_gen::next() {
+	this->state ^= this->state >> 12;
+	this->state ^= this->state << 25;
+	this->state ^= this->state >> 27;
+
+	return this->state * 0x2545f4914f6cdd1dULL;
+}
+
+/**
+* @fn below
+* @brief Draws a number in [0, n).
+* @param n - Num of possible values, at least 1.
+* @return The number.
+*/
+uint32_t trace_gen::below(uint32_t n) {
+	/* high bits are the best ones, scaled to the range without division */
+	return static_cast<uint32_t>(((this->next() >> 32) * n) >> 32);
+}
+
+/**
+* @fn chance
+* @brief Draws whether an event of a given probability happened.
+* @param p - Probability of the event.
+* @return True if it happened.
+*/
+bool trace_gen::chance(double p) {
+	return this->unit() < p;
+}
+
+/**
+* @fn unit
+* @brief Draws a number in [0, 1).
+* @return The number.
+*/
+double trace_gen::unit() {
+	/* 53 bits fill the mantissa of a double */
+	return (this->next() >> 11) * (1.0 / (1ULL << 53));
+}
+
+/**
+* @fn random_ip
+* @brief Draws an IP, in the NIC's local net with local_ip_ratio.
+* @param ip[out] - The IP.
+* @return None.
+*/
+void trace_gen::random_ip(uint8_t ip[]) {
+	bool local = this->chance(this->config.local_ip_ratio);
+
+	for (int i = 0; i < IP_V4_SIZE; i++) {
+		ip[i] = this->below(256);
+
+		if (!local) {
+			continue;
+		}
+
+		/* bits of this byte that are in the prefix come from the NIC */
+		int prefix_bits = this->config.mask_len - i * 8;
+		if (prefix_bits >= 8) {
+			ip[i] = this->nic_ip[i];
+		} else if (prefix_bits > 0) {
+			uint8_t mask = 0xff << (8 - prefix_bits);
+			ip[i] = (this->nic_ip[i] & mask) | (ip[i] & ~mask);
+		}
+	}
+}
+
+/**
+* @fn sum_bytes
+* @brief Sums the bytes of a number, as packets' checksums do.
+* @param num - The number.
+* @return The sum.
+*/
+unsigned int trace_gen::sum_bytes(unsigned int num) {
+	unsigned int sum = 0;
+	while (num > 0) {
+		sum += num & 0xff;
+		num >>= 8;
+	}
+
+	return sum;
+}
+
+/**
+* @fn write_mac
+* @brief Appends a MAC in format "xx:xx:xx:xx:xx:xx".
+* @param mac[] - The MAC.
+* @param out[out] - The buffer to append the MAC to.
+* @return None.
+*/
+void trace_gen::write_mac(const uint8_t mac[], out_buffer &out) {
+	for (int i = 0; i < MAC_SIZE; i++) {
+		if (i > 0) {
+			out.append(':');
+		}
+
+		out.append_hex(mac + i, 1);
+	}
+}
+
+/**
+* @fn write_ip
+* @brief Appends an IP in format "d.d.d.d".
+* @param ip[] - The IP.
+* @param out[out] - The buffer to append the IP to.
+* @return None.
+*/
+void trace_gen::write_ip(const uint8_t ip[], out_buffer &out) {
+	for (int i = 0; i < IP_V4_SIZE; i++) {
+		if (i > 0) {
+			out.append('.');
+		}
+
+		out.append_uint(ip[i]);
+	}
+}
@@ -0,0 +1,175 @@
+#ifndef __TRACE_GEN__
+#define __TRACE_GEN__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "common.hpp"
+#include "out_buffer.h"
+
+/* Shape of the traffic trace_gen makes */
+struct trace_config {
+    /* same seed and config always give the same files */
+    uint64_t seed;
+    unsigned long packets_num;
+    /* share of L2 and L3 packets, the rest are L4 */
+    double l2_ratio;
+    double l3_ratio;
+    /* num of open ports of the NIC */
+    int ports_num;
+    /* prefix length of the NIC's local net */
+    int mask_len;
+    /* share of packets with a wrong checksum, of the layers that have one */
+    double bad_cs_ratio;
+    /* share of packets sent to one of the open ports */
+    double open_port_ratio;
+    /* share of IPs in the NIC's local net, and of L2 packets to its MAC */
+    double local_ip_ratio;
+    double nic_mac_ratio;
+    /* share of packets that repeat one of the last packets, as
+       retransmissions do */
+    double repeat_ratio;
+
+    trace_config(): seed(1),
+                    packets_num(100000),
+                    l2_ratio(0.4),
+                    l3_ratio(0.3),
+                    ports_num(40),
+                    mask_len(16),
+                    bad_cs_ratio(0.1),
+                    open_port_ratio(0.8),
+                    local_ip_ratio(0.5),
+                    nic_mac_ratio(0.85),
+                    repeat_ratio(0) {}
+};
+
+/* Deterministic generator of a NIC's parameters file and a packets file
+   of synthetic traffic, for benchmarks. Uses its own random generator,
+   so the files are the same on every platform. */
+class trace_gen {
+	trace_config config;
+	uint64_t state;
+
+	uint8_t nic_mac[MAC_SIZE];
+	uint8_t nic_ip[IP_V4_SIZE];
+	std::vector<uint16_t> src_ports;
+	std::vector<uint16_t> dst_ports;
+	/* last packet lines, for repeat_ratio, the oldest replaced first */
+	std::vector<std::string> recent;
+	size_t recent_next;
+
+	public:
+
+		/**
+		* @fn trace_gen
+		* @brief Constructor of the class, draws the NIC's parameters.
+		* @param config - Shape of the traffic.
+		* @return New generator object.
+		*/
+		trace_gen(const trace_config &config);
+
+		/**
+		* @fn write_params
+		* @brief Appends the NIC's parameters file: MAC, "ip/mask" and a
+		*		 "src:<port>,dst:<port>" line per open port.
+		* @param out[out] - The buffer to append the file to.
+		* @return None.
+		*/
+		void write_params(out_buffer &out) const;
+
+		/**
+		* @fn next_line
+		* @brief Appends the next packet line, followed by '\n'. With
+		*		 repeat_ratio it may be a copy of a recent line.
+		* @param out[out] - The buffer to append the line to.
+		* @return None.
+		*/
+		void next_line(out_buffer &out);
+
+		/**
+		* @fn write_files
+		* @brief Writes the parameters file and packets_num packet lines.
+		* @param param_file - Name of the parameters file to create.
+		* @param packet_file - Name of the packets file to create.
+		* @return None, throws std::invalid_argument if a file can't be
+		*		  written.
+		*/
+		void write_files(const std::string &param_file,
+						 const std::string &packet_file);
+
+	private:
+
+		/**
+		* @fn new_line
+		* @brief Appends a packet line drawn from scratch, followed by
+		*		 '\n'.
+		* @param out[out] - The buffer to append the line to.
+		* @return None.
+		*/
+		void new_line(out_buffer &out);
+
+		/**
+		* @fn next
+		* @brief Draws the next 64 random bits (xorshift64*).
+		* @return The random bits.
+		*/
+		uint64_t next();
+
+		/**
+		* @fn below
+		* @brief Draws a number in [0, n).
+		* @param n - Num of possible values, at least 1.
+		* @return The number.
+		*/
+		uint32_t below(uint32_t n);
+
+		/**
+		* @fn chance
+		* @brief Draws whether an event of a given probability happened.
+		* @param p - Probability of the event.
+		* @return True if it happened.
+		*/
+		bool chance(double p);
+
+		/**
+		* @fn unit
+		* @brief Draws a number in [0, 1).
+		* @return The number.
+		*/
+		double unit();
+
+		/**
+		* @fn random_ip
+		* @brief Draws an IP, in the NIC's local net with local_ip_ratio.
+		* @param ip[out] - The IP.
+		* @return None.
+		*/
+		void random_ip(uint8_t ip[]);
+
+		/**
+		* @fn sum_bytes
+		* @brief Sums the bytes of a number, as packets' checksums do.
+		* @param num - The number.
+		* @return The sum.
+		*/
+		static unsigned int sum_bytes(unsigned int num);
+
+		/**
+		* @fn write_mac
+		* @brief Appends a MAC in format "xx:xx:xx:xx:xx:xx".
+		* @param mac[] - The MAC.
+		* @param out[out] - The buffer to append the MAC to.
+		* @return None.
+		*/
+		static void write_mac(const uint8_t mac[], out_buffer &out);
+
+		/**
+		* @fn write_ip
+		* @brief Appends an IP in format "d.d.d.d".
+		* @param ip[] - The IP.
+		* @param out[out] - The buffer to append the IP to.
+		* @return None.
+		*/
+		static void write_ip(const uint8_t ip[], out_buffer &out);
+};
+#endif
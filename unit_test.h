@@ -0,0 +1,35 @@
+#ifndef __UNIT_TEST__
+#define __UNIT_TEST__
+
+#include <cstdio>
+
+/* Num of checks that failed in the running test program */
+static int unit_test_failures = 0;
+
+/* Checks a condition of a test, a failure is reported and counted but
+   doesn't stop the test, so one run shows all of them */
+#define CHECK(cond)														\
+	do {																\
+		if (!(cond)) {													\
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n",				\
+					__FILE__, __LINE__, #cond);							\
+			unit_test_failures++;										\
+		}																\
+	} while (0)
+
+/**
+* @fn unit_test_result
+* @brief Reports the result of a test program, its main returns it.
+* @param name - Name of the tested class.
+* @return 0 if all checks passed, 1 otherwise.
+*/
+static inline int unit_test_result(const char* name) {
+	if (unit_test_failures != 0) {
+		fprintf(stderr, "%s: %d checks failed\n", name, unit_test_failures);
+		return 1;
+	}
+
+	printf("%s: passed\n", name);
+	return 0;
+}
+#endif